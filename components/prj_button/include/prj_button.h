@@ -0,0 +1,86 @@
+/**
+ * @file prj_button.h
+ * @date 05/30/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef PRJ_BUTTON_H
+#define PRJ_BUTTON_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "prj_common.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_BUTTON_TAG "BUTTON"
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef enum
+{
+    PRJ_BUTTON_1 = 0, /*!< CONFIG_BUTTON_GPIO_1 */
+    PRJ_BUTTON_2,     /*!< CONFIG_BUTTON_GPIO_2 */
+    PRJ_BUTTON_MAX,
+} prj_button_id_t;
+
+typedef enum
+{
+    PRJ_BUTTON_EVENT_RELEASE = 0,
+    PRJ_BUTTON_EVENT_PRESS,
+    PRJ_BUTTON_EVENT_DOUBLE_CLICK, /*!< Follows the PRESS of the second click */
+    PRJ_BUTTON_EVENT_LONG_PRESS,   /*!< Held for CONFIG_PRJ_BUTTON_LONG_PRESS_MS, RELEASE follows later */
+} prj_button_event_type_t;
+
+typedef struct
+{
+    prj_u32_t time_us; /*!< Low 32 bits of the esp_timer time of the edge or deadline behind the event */
+    prj_u8_t button;   /*!< prj_button_id_t */
+    prj_u8_t type;     /*!< prj_button_event_type_t */
+} prj_button_event_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/**
+ * @brief Configure the button GPIOs and start taking edge interrupts.
+ *
+ * Installs the GPIO ISR service if nobody did before. Debouncing runs in one esp_timer per button,
+ * there is no polling task.
+ *
+ * @return PRJ_SUCCESS, PRJ_ERROR_INVALID_STATE if already initialized or PRJ_ERROR_RESOURCES.
+ */
+prj_status_t prj_button_init (void);
+
+/**
+ * @brief Remove the interrupt handlers, delete the timers and drop pending events.
+ *
+ * @return PRJ_SUCCESS or PRJ_ERROR_INVALID_STATE if not initialized.
+ */
+prj_status_t prj_button_deinit (void);
+
+/**
+ * @brief Take the oldest button event, waiting for one if the queue is empty. Single consumer only.
+ *
+ * The queue is lock-free, the wait only blocks on a semaphore given after each push.
+ *
+ * @param p_event    Output event.
+ * @param timeout_ms Wait in milliseconds, 0 to poll.
+ *
+ * @return PRJ_SUCCESS, PRJ_ERROR_TIMEOUT, PRJ_ERROR_NULL or PRJ_ERROR_INVALID_STATE.
+ */
+prj_status_t prj_button_event_get (prj_button_event_t *const p_event, const prj_u32_t timeout_ms);
+
+/**
+ * @brief Number of events dropped because the consumer fell behind.
+ */
+prj_u32_t prj_button_dropped (void);
+#endif /* PRJ_BUTTON_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,85 @@
+/**
+ * @file prj_button_fsm.h
+ * @date 05/30/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef PRJ_BUTTON_FSM_H
+#define PRJ_BUTTON_FSM_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "prj_common.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_BUTTON_FSM_EVENT_RELEASE      (0x01U) /*!< Debounced release */
+#define PRJ_BUTTON_FSM_EVENT_PRESS        (0x02U) /*!< Debounced press */
+#define PRJ_BUTTON_FSM_EVENT_DOUBLE_CLICK (0x04U) /*!< Press started within the double click window */
+#define PRJ_BUTTON_FSM_EVENT_LONG_PRESS   (0x08U) /*!< Held for the long press time */
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef enum
+{
+    PRJ_BUTTON_FSM_INPUT_EDGE = 0, /*!< GPIO edge interrupt */
+    PRJ_BUTTON_FSM_INPUT_TIMER,    /*!< Deadline timer expired */
+} prj_button_fsm_input_t;
+
+typedef struct
+{
+    prj_u32_t events;      /*!< PRJ_BUTTON_FSM_EVENT_* flags, to be reported in ascending bit order */
+    prj_i64_t deadline_us; /*!< Time to feed the next PRJ_BUTTON_FSM_INPUT_TIMER, 0 for none */
+} prj_button_fsm_output_t;
+
+typedef struct
+{
+    prj_u32_t debounce_us; /*!< Edges this soon after an accepted one are bounce */
+    prj_u32_t long_us;     /*!< Hold time for a long press */
+    prj_u32_t double_us;   /*!< Maximum gap between a click release and the next press */
+} prj_button_fsm_config_t;
+
+typedef struct
+{
+    prj_button_fsm_config_t config;
+    prj_bool_t pressed;         /*!< Debounced state */
+    prj_bool_t click_armed;     /*!< Last release ended a click that may start a double click */
+    prj_bool_t click_used;      /*!< Current press already was a long press or a double click */
+    prj_i64_t lockout_until_us; /*!< End of the debounce window, 0 if none */
+    prj_i64_t long_at_us;       /*!< Long press deadline, 0 if none */
+    prj_i64_t release_us;       /*!< Time of the last click release */
+} prj_button_fsm_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/**
+ * @brief Initialize the button state machine in the released state.
+ */
+void prj_button_fsm_init (prj_button_fsm_t *const p_fsm, const prj_button_fsm_config_t *const p_config);
+
+/**
+ * @brief Feed an edge or timer input into the button state machine.
+ *
+ * The first edge after a quiet period is taken at once, so a press is reported with interrupt latency.
+ * Later edges within the debounce window are ignored and the level is sampled again when it ends.
+ * Pure function of the state, the input, the level and the time, so edge traces can be replayed on the host.
+ *
+ * @param p_fsm   State machine.
+ * @param input   Input kind.
+ * @param pressed Button level at the input, true if pressed.
+ * @param now_us  Time of the input in microseconds.
+ *
+ * @return Events to report and the deadline to arm.
+ */
+prj_button_fsm_output_t prj_button_fsm_step (prj_button_fsm_t *const p_fsm, const prj_button_fsm_input_t input,
+                                             const prj_bool_t pressed, const prj_i64_t now_us);
+#endif /* PRJ_BUTTON_FSM_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
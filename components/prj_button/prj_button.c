@@ -0,0 +1,341 @@
+/**
+ * @file prj_button.c
+ * @date 05/30/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "prj_button.h"
+#include "prj_button_fsm.h"
+
+#include <stdatomic.h>
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_BUTTON_QUEUE_LEN  (CONFIG_PRJ_BUTTON_QUEUE_LEN)
+#define PRJ_BUTTON_QUEUE_MASK (PRJ_BUTTON_QUEUE_LEN - 1U)
+#define PRJ_BUTTON_US_PER_MS  (1000U)
+
+#if CONFIG_PRJ_BUTTON_ACTIVE_LOW
+#define PRJ_BUTTON_PRESSED_LEVEL (0)
+#else
+#define PRJ_BUTTON_PRESSED_LEVEL (1)
+#endif
+
+_Static_assert((PRJ_BUTTON_QUEUE_LEN & PRJ_BUTTON_QUEUE_MASK) == 0U, "CONFIG_PRJ_BUTTON_QUEUE_LEN must be a power of two");
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    gpio_num_t gpio;
+    prj_button_fsm_t fsm;
+    esp_timer_handle_t timer; /*!< Fires at the end of the debounce window and at the long press time */
+} prj_button_ctx_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void button_isr (void *p_arg);
+static void button_timer_cb (void *p_arg);
+static prj_bool_t button_feed (const prj_button_id_t id, const prj_button_fsm_input_t input);
+static prj_bool_t button_push (const prj_button_id_t id, const prj_button_event_type_t type, const prj_i64_t time_us);
+static prj_bool_t button_pop (prj_button_event_t *const p_event);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static prj_button_ctx_t m_buttons[PRJ_BUTTON_MAX] = {
+    [PRJ_BUTTON_1] = {.gpio = CONFIG_BUTTON_GPIO_1},
+    [PRJ_BUTTON_2] = {.gpio = CONFIG_BUTTON_GPIO_2},
+};
+
+/* Serializes the state machines and the producer side of the queue between the ISR and the timer task */
+static portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static prj_button_event_t m_queue[PRJ_BUTTON_QUEUE_LEN];
+static _Atomic prj_u32_t m_head = 0U; /*!< Next position to write, producers under m_lock */
+static _Atomic prj_u32_t m_tail = 0U; /*!< Next position to read, consumer only */
+static _Atomic prj_u32_t m_dropped = 0U;
+
+static StaticSemaphore_t m_sem_buf;
+static SemaphoreHandle_t m_sem = NULL;
+static prj_bool_t m_ready = false;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+prj_status_t prj_button_init (void)
+{
+    const prj_button_fsm_config_t fsm_config = {
+        .debounce_us = CONFIG_PRJ_BUTTON_DEBOUNCE_MS * PRJ_BUTTON_US_PER_MS,
+        .long_us     = CONFIG_PRJ_BUTTON_LONG_PRESS_MS * PRJ_BUTTON_US_PER_MS,
+        .double_us   = CONFIG_PRJ_BUTTON_DOUBLE_CLICK_MS * PRJ_BUTTON_US_PER_MS,
+    };
+    gpio_config_t io_config = {
+        .mode         = GPIO_MODE_INPUT,
+        .pull_up_en   = CONFIG_PRJ_BUTTON_ACTIVE_LOW ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE,
+        .pull_down_en = CONFIG_PRJ_BUTTON_ACTIVE_LOW ? GPIO_PULLDOWN_DISABLE : GPIO_PULLDOWN_ENABLE,
+        .intr_type    = GPIO_INTR_ANYEDGE,
+    };
+    esp_err_t err = ESP_OK;
+
+    if (m_ready)
+    {
+        ESP_LOGW(PRJ_BUTTON_TAG, "button init: already initialized");
+        return PRJ_ERROR_INVALID_STATE;
+    }
+
+    m_sem = xSemaphoreCreateBinaryStatic(&m_sem_buf);
+    atomic_store_explicit(&m_head, 0U, memory_order_relaxed);
+    atomic_store_explicit(&m_tail, 0U, memory_order_relaxed);
+    atomic_store_explicit(&m_dropped, 0U, memory_order_relaxed);
+
+    for (prj_size_t i = 0U; i < PRJ_BUTTON_MAX; i++)
+    {
+        const esp_timer_create_args_t timer_args = {
+            .callback = button_timer_cb,
+            .arg      = (void *)i,
+            .name     = "button",
+        };
+
+        prj_button_fsm_init(&m_buttons[i].fsm, &fsm_config);
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &m_buttons[i].timer));
+        io_config.pin_bit_mask |= (1ULL << m_buttons[i].gpio);
+    }
+
+    ESP_ERROR_CHECK(gpio_config(&io_config));
+
+    /* The service may already be installed by another component */
+    err = gpio_install_isr_service(0);
+    if ((err != ESP_OK) && (err != ESP_ERR_INVALID_STATE))
+    {
+        ESP_LOGE(PRJ_BUTTON_TAG, "button init: isr service install failed: %s", esp_err_to_name(err));
+
+        for (prj_size_t i = 0U; i < PRJ_BUTTON_MAX; i++)
+        {
+            esp_timer_delete(m_buttons[i].timer);
+            m_buttons[i].timer = NULL;
+        }
+
+        vSemaphoreDelete(m_sem);
+        m_sem = NULL;
+
+        return PRJ_ERROR_RESOURCES;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+    m_ready = true;
+    portEXIT_CRITICAL(&m_lock);
+
+    for (prj_size_t i = 0U; i < PRJ_BUTTON_MAX; i++)
+    {
+        ESP_ERROR_CHECK(gpio_isr_handler_add(m_buttons[i].gpio, button_isr, (void *)i));
+
+        /* A button held since boot never produces an edge, take its level now */
+        portENTER_CRITICAL(&m_lock);
+        (void)button_feed((prj_button_id_t)i, PRJ_BUTTON_FSM_INPUT_EDGE);
+        portEXIT_CRITICAL(&m_lock);
+    }
+
+    ESP_LOGI(PRJ_BUTTON_TAG, "button init: gpio %d and %d ready", m_buttons[PRJ_BUTTON_1].gpio, m_buttons[PRJ_BUTTON_2].gpio);
+
+    return PRJ_SUCCESS;
+}
+
+prj_status_t prj_button_deinit (void)
+{
+    if (!m_ready)
+    {
+        ESP_LOGW(PRJ_BUTTON_TAG, "button deinit: not initialized");
+        return PRJ_ERROR_INVALID_STATE;
+    }
+
+    /* A callback already waiting for the lock sees this and neither pushes nor re-arms its timer */
+    portENTER_CRITICAL(&m_lock);
+    m_ready = false;
+    portEXIT_CRITICAL(&m_lock);
+
+    /* The ISR service stays installed, other components may have handlers on it */
+    for (prj_size_t i = 0U; i < PRJ_BUTTON_MAX; i++)
+    {
+        gpio_intr_disable(m_buttons[i].gpio);
+        gpio_isr_handler_remove(m_buttons[i].gpio);
+        esp_timer_stop(m_buttons[i].timer);
+        ESP_ERROR_CHECK(esp_timer_delete(m_buttons[i].timer));
+        m_buttons[i].timer = NULL;
+        gpio_reset_pin(m_buttons[i].gpio);
+    }
+
+    vSemaphoreDelete(m_sem);
+    m_sem = NULL;
+
+    return PRJ_SUCCESS;
+}
+
+prj_status_t prj_button_event_get (prj_button_event_t *const p_event, const prj_u32_t timeout_ms)
+{
+    TimeOut_t timeout = {0};
+    TickType_t ticks_left = pdMS_TO_TICKS(timeout_ms);
+
+    if (p_event == NULL)
+    {
+        return PRJ_ERROR_NULL;
+    }
+
+    if (!m_ready)
+    {
+        return PRJ_ERROR_INVALID_STATE;
+    }
+
+    vTaskSetTimeOutState(&timeout);
+
+    /* A give left over from an event popped without waiting wakes us once more, so loop until the deadline */
+    while (!button_pop(p_event))
+    {
+        if ((xTaskCheckForTimeOut(&timeout, &ticks_left) != pdFALSE) || (xSemaphoreTake(m_sem, ticks_left) != pdTRUE))
+        {
+            return button_pop(p_event) ? PRJ_SUCCESS : PRJ_ERROR_TIMEOUT;
+        }
+    }
+
+    return PRJ_SUCCESS;
+}
+
+prj_u32_t prj_button_dropped (void)
+{
+    return atomic_load_explicit(&m_dropped, memory_order_relaxed);
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static IRAM_ATTR void button_isr (void *p_arg)
+{
+    BaseType_t woken = pdFALSE;
+    prj_bool_t pushed = false;
+
+    portENTER_CRITICAL_ISR(&m_lock);
+    pushed = button_feed((prj_button_id_t)(prj_size_t)p_arg, PRJ_BUTTON_FSM_INPUT_EDGE);
+    portEXIT_CRITICAL_ISR(&m_lock);
+
+    if (pushed)
+    {
+        xSemaphoreGiveFromISR(m_sem, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+
+    return;
+}
+
+static void button_timer_cb (void *p_arg)
+{
+    prj_bool_t pushed = false;
+
+    portENTER_CRITICAL(&m_lock);
+    pushed = button_feed((prj_button_id_t)(prj_size_t)p_arg, PRJ_BUTTON_FSM_INPUT_TIMER);
+    portEXIT_CRITICAL(&m_lock);
+
+    if (pushed)
+    {
+        xSemaphoreGive(m_sem);
+    }
+
+    return;
+}
+
+/* Called with m_lock held, from the ISR as well */
+static IRAM_ATTR prj_bool_t button_feed (const prj_button_id_t id, const prj_button_fsm_input_t input)
+{
+    prj_button_ctx_t *const p_button = &m_buttons[id];
+    const prj_i64_t now_us = esp_timer_get_time();
+    prj_button_fsm_output_t out = {0};
+    prj_bool_t pushed = false;
+
+    if (!m_ready)
+    {
+        return false;
+    }
+
+    out = prj_button_fsm_step(&p_button->fsm, input, gpio_get_level(p_button->gpio) == PRJ_BUTTON_PRESSED_LEVEL, now_us);
+
+    /* Ascending flag order is the order the events happened in */
+    if ((out.events & PRJ_BUTTON_FSM_EVENT_RELEASE) != 0U)
+    {
+        pushed |= button_push(id, PRJ_BUTTON_EVENT_RELEASE, now_us);
+    }
+
+    if ((out.events & PRJ_BUTTON_FSM_EVENT_PRESS) != 0U)
+    {
+        pushed |= button_push(id, PRJ_BUTTON_EVENT_PRESS, now_us);
+    }
+
+    if ((out.events & PRJ_BUTTON_FSM_EVENT_DOUBLE_CLICK) != 0U)
+    {
+        pushed |= button_push(id, PRJ_BUTTON_EVENT_DOUBLE_CLICK, now_us);
+    }
+
+    if ((out.events & PRJ_BUTTON_FSM_EVENT_LONG_PRESS) != 0U)
+    {
+        pushed |= button_push(id, PRJ_BUTTON_EVENT_LONG_PRESS, now_us);
+    }
+
+    /* Re-arm for the earliest pending deadline, an edge may have moved it */
+    esp_timer_stop(p_button->timer);
+
+    if (out.deadline_us != 0)
+    {
+        esp_timer_start_once(p_button->timer, (out.deadline_us > now_us) ? (prj_u64_t)(out.deadline_us - now_us) : 1U);
+    }
+
+    return pushed;
+}
+
+static IRAM_ATTR prj_bool_t button_push (const prj_button_id_t id, const prj_button_event_type_t type, const prj_i64_t time_us)
+{
+    const prj_u32_t head = atomic_load_explicit(&m_head, memory_order_relaxed);
+    const prj_u32_t tail = atomic_load_explicit(&m_tail, memory_order_acquire);
+    prj_button_event_t *const p_slot = &m_queue[head & PRJ_BUTTON_QUEUE_MASK];
+
+    if ((head - tail) >= PRJ_BUTTON_QUEUE_LEN)
+    {
+        atomic_fetch_add_explicit(&m_dropped, 1U, memory_order_relaxed);
+        return false;
+    }
+
+    p_slot->time_us = (prj_u32_t)time_us;
+    p_slot->button = (prj_u8_t)id;
+    p_slot->type = (prj_u8_t)type;
+    atomic_store_explicit(&m_head, head + 1U, memory_order_release);
+
+    return true;
+}
+
+static prj_bool_t button_pop (prj_button_event_t *const p_event)
+{
+    const prj_u32_t tail = atomic_load_explicit(&m_tail, memory_order_relaxed);
+    const prj_u32_t head = atomic_load_explicit(&m_head, memory_order_acquire);
+
+    if (head == tail)
+    {
+        return false;
+    }
+
+    *p_event = m_queue[tail & PRJ_BUTTON_QUEUE_MASK];
+    atomic_store_explicit(&m_tail, tail + 1U, memory_order_release);
+
+    return true;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,128 @@
+/**
+ * @file prj_button_fsm.c
+ * @date 05/30/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "prj_button_fsm.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static prj_u32_t button_fsm_transition (prj_button_fsm_t *const p_fsm, const prj_bool_t pressed, const prj_i64_t now_us);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void prj_button_fsm_init (prj_button_fsm_t *const p_fsm, const prj_button_fsm_config_t *const p_config)
+{
+    *p_fsm = (prj_button_fsm_t){0};
+    p_fsm->config = *p_config;
+
+    return;
+}
+
+prj_button_fsm_output_t prj_button_fsm_step (prj_button_fsm_t *const p_fsm, const prj_button_fsm_input_t input,
+                                             const prj_bool_t pressed, const prj_i64_t now_us)
+{
+    prj_button_fsm_output_t out = {0};
+
+    switch (input)
+    {
+        case PRJ_BUTTON_FSM_INPUT_EDGE:
+            /* Bounce inside the window is ignored, the level is sampled again when it ends */
+            if ((p_fsm->lockout_until_us == 0) && (pressed != p_fsm->pressed))
+            {
+                out.events = button_fsm_transition(p_fsm, pressed, now_us);
+            }
+            break;
+
+        case PRJ_BUTTON_FSM_INPUT_TIMER:
+            if ((p_fsm->lockout_until_us != 0) && (now_us >= p_fsm->lockout_until_us))
+            {
+                p_fsm->lockout_until_us = 0;
+
+                /* The contact settled on the other level while edges were ignored */
+                if (pressed != p_fsm->pressed)
+                {
+                    out.events = button_fsm_transition(p_fsm, pressed, now_us);
+                }
+            }
+
+            if ((p_fsm->long_at_us != 0) && (now_us >= p_fsm->long_at_us) && p_fsm->pressed)
+            {
+                out.events |= PRJ_BUTTON_FSM_EVENT_LONG_PRESS;
+                p_fsm->long_at_us = 0;
+                p_fsm->click_used = true;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if ((p_fsm->lockout_until_us != 0) && ((p_fsm->long_at_us == 0) || (p_fsm->lockout_until_us < p_fsm->long_at_us)))
+    {
+        out.deadline_us = p_fsm->lockout_until_us;
+    }
+    else
+    {
+        out.deadline_us = p_fsm->long_at_us;
+    }
+
+    return out;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static prj_u32_t button_fsm_transition (prj_button_fsm_t *const p_fsm, const prj_bool_t pressed, const prj_i64_t now_us)
+{
+    prj_u32_t events = 0U;
+
+    p_fsm->pressed = pressed;
+    p_fsm->lockout_until_us = now_us + p_fsm->config.debounce_us;
+
+    if (pressed)
+    {
+        events = PRJ_BUTTON_FSM_EVENT_PRESS;
+        p_fsm->click_used = false;
+        p_fsm->long_at_us = now_us + p_fsm->config.long_us;
+
+        if (p_fsm->click_armed && ((now_us - p_fsm->release_us) <= (prj_i64_t)p_fsm->config.double_us))
+        {
+            events |= PRJ_BUTTON_FSM_EVENT_DOUBLE_CLICK;
+            /* The second click must not start another double click */
+            p_fsm->click_used = true;
+        }
+
+        p_fsm->click_armed = false;
+    }
+    else
+    {
+        events = PRJ_BUTTON_FSM_EVENT_RELEASE;
+        p_fsm->long_at_us = 0;
+        p_fsm->click_armed = !p_fsm->click_used;
+        p_fsm->release_us = now_us;
+    }
+
+    return events;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
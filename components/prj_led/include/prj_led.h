@@ -0,0 +1,88 @@
+/**
+ * @file prj_led.h
+ * @date 06/02/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef PRJ_LED_H
+#define PRJ_LED_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "prj_common.h"
+#include "prj_led_seq.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_LED_TAG "LED"
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+/**
+ * @brief Device states shown on the status LED. When several are active the lowest value wins.
+ */
+typedef enum
+{
+    PRJ_LED_STATE_LOW_HEAP = 0, /*!< Free heap below CONFIG_PRJ_LED_LOW_HEAP_BYTES, tracked by the component */
+    PRJ_LED_STATE_SYNC_FAILED,  /*!< Last time sync failed */
+    PRJ_LED_STATE_CONNECTING,   /*!< Wi-Fi station connecting or reconnecting */
+    PRJ_LED_STATE_CONNECTED,    /*!< Wi-Fi station has an IP address */
+    PRJ_LED_STATE_MAX,
+} prj_led_state_t;
+
+typedef struct
+{
+    void (*level_set)(const prj_bool_t on); /*!< Drive the LED, called from the esp_timer task */
+} prj_led_output_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/**
+ * @brief Configure CONFIG_BLINK_GPIO and the pattern timer. The LED stays off until a state is set.
+ *
+ * Patterns are stepped from one esp_timer callback, there is no task. The timer only fires at
+ * pattern steps and, with the low heap check enabled, at least once a second.
+ *
+ * @return PRJ_SUCCESS or PRJ_ERROR_INVALID_STATE if already initialized.
+ */
+prj_status_t prj_led_init (void);
+
+/**
+ * @brief Stop the pattern, switch the LED off and delete the timer.
+ *
+ * @return PRJ_SUCCESS or PRJ_ERROR_INVALID_STATE if not initialized.
+ */
+prj_status_t prj_led_deinit (void);
+
+/**
+ * @brief Activate or clear a device state. The pattern restarts only if the winning state changes.
+ *
+ * Does not block, safe to call from event callbacks. States set before prj_led_init() are kept.
+ */
+void prj_led_state_set (const prj_led_state_t state, const prj_bool_t active);
+
+/**
+ * @brief Pattern played for a state.
+ *
+ * @return Pattern or NULL for an invalid state.
+ */
+const prj_led_pattern_t *prj_led_pattern_get (const prj_led_state_t state);
+
+/**
+ * @brief Replace the LED output, e.g. with a fake GPIO on the Linux host target.
+ *
+ * Call before prj_led_init().
+ *
+ * @param p_output Output, NULL restores CONFIG_BLINK_GPIO. Must stay valid while in use.
+ */
+void prj_led_output_set (const prj_led_output_t *const p_output);
+#endif /* PRJ_LED_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
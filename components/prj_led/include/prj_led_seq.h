@@ -0,0 +1,72 @@
+/**
+ * @file prj_led_seq.h
+ * @date 06/02/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef PRJ_LED_SEQ_H
+#define PRJ_LED_SEQ_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "prj_common.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/**
+ * @brief Declare a pattern from its on and off times in milliseconds, e.g. PRJ_LED_PATTERN(true, 100, 900).
+ */
+#define PRJ_LED_PATTERN(loop, ...)                                                              \
+    {                                                                                           \
+        .p_steps_ms = (const prj_u16_t[]){__VA_ARGS__},                                         \
+        .count      = (prj_u8_t)(sizeof((const prj_u16_t[]){__VA_ARGS__}) / sizeof(prj_u16_t)), \
+        .repeat     = (loop),                                                                   \
+    }
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    const prj_u16_t *p_steps_ms; /*!< Alternating on and off times starting with on, none of them 0 */
+    prj_u8_t count;              /*!< Number of steps */
+    prj_bool_t repeat;           /*!< Loop forever, otherwise the last step is held */
+} prj_led_pattern_t;
+
+typedef struct
+{
+    const prj_led_pattern_t *p_pattern;
+    prj_u8_t index; /*!< Next step */
+} prj_led_seq_t;
+
+typedef struct
+{
+    prj_bool_t on;     /*!< LED level for this step */
+    prj_u32_t hold_ms; /*!< Time until the next step, 0 to hold the level until another pattern starts */
+} prj_led_seq_step_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/**
+ * @brief Restart the sequencer on a pattern.
+ *
+ * @param p_seq     Sequencer.
+ * @param p_pattern Pattern, NULL for off. Must stay valid while in use.
+ */
+void prj_led_seq_start (prj_led_seq_t *const p_seq, const prj_led_pattern_t *const p_pattern);
+
+/**
+ * @brief Take the next step of the pattern.
+ *
+ * Pure function of the sequencer state, so pattern playback can be checked on the host.
+ */
+prj_led_seq_step_t prj_led_seq_next (prj_led_seq_t *const p_seq);
+#endif /* PRJ_LED_SEQ_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
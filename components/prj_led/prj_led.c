@@ -0,0 +1,298 @@
+/**
+ * @file prj_led.c
+ * @date 06/02/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "prj_led.h"
+
+#include "esp_timer.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "driver/gpio.h"
+#include "esp_heap_caps.h"
+#endif
+#include "freertos/FreeRTOS.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_LED_US_PER_MS      (1000U)
+#define PRJ_LED_HEAP_CHECK_MS  (1000U) /* Wake-up while a level is held, only for the low heap check */
+
+/* The host heap has no capabilities API */
+#if (CONFIG_PRJ_LED_LOW_HEAP_BYTES > 0) && !CONFIG_IDF_TARGET_LINUX
+#define PRJ_LED_HEAP_CHECK     (1)
+#else
+#define PRJ_LED_HEAP_CHECK     (0)
+#endif
+/* Free heap must climb this much above the threshold before the warning clears */
+#define PRJ_LED_HEAP_HYST      (CONFIG_PRJ_LED_LOW_HEAP_BYTES / 8)
+
+#if CONFIG_PRJ_LED_ACTIVE_LOW
+#define PRJ_LED_ON_LEVEL       (0U)
+#define PRJ_LED_OFF_LEVEL      (1U)
+#else
+#define PRJ_LED_ON_LEVEL       (1U)
+#define PRJ_LED_OFF_LEVEL      (0U)
+#endif
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void led_timer_cb (void *p_arg);
+static void led_update (void);
+static void led_step (void);
+static void led_heap_check (void);
+#if !CONFIG_IDF_TARGET_LINUX
+static void led_gpio_level_set (const prj_bool_t on);
+#endif
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static const prj_led_pattern_t m_patterns[PRJ_LED_STATE_MAX] = {
+    /* Three short flashes */
+    [PRJ_LED_STATE_LOW_HEAP]    = PRJ_LED_PATTERN(true, 100, 150, 100, 150, 100, 1400),
+    /* Two short flashes */
+    [PRJ_LED_STATE_SYNC_FAILED] = PRJ_LED_PATTERN(true, 100, 150, 100, 1650),
+    /* Fast even blink */
+    [PRJ_LED_STATE_CONNECTING]  = PRJ_LED_PATTERN(true, 100, 100),
+    /* Heartbeat */
+    [PRJ_LED_STATE_CONNECTED]   = PRJ_LED_PATTERN(true, 50, 2950),
+};
+
+#if CONFIG_IDF_TARGET_LINUX
+static const prj_led_output_t m_output_default = {0};
+#else
+static const prj_led_output_t m_output_default = {
+    .level_set = led_gpio_level_set,
+};
+#endif
+
+static portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+static const prj_led_output_t *m_output = &m_output_default;
+static esp_timer_handle_t m_timer = NULL;
+static prj_led_seq_t m_seq = {0};
+static prj_u32_t m_states = 0U; /* Bit per prj_led_state_t */
+static prj_bool_t m_ready = false;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+prj_status_t prj_led_init (void)
+{
+    const esp_timer_create_args_t timer_args = {
+        .callback = led_timer_cb,
+        .name     = "prj_led",
+    };
+
+    if (m_ready)
+    {
+        ESP_LOGW(PRJ_LED_TAG, "led init: already initialized");
+        return PRJ_ERROR_INVALID_STATE;
+    }
+
+#if !CONFIG_IDF_TARGET_LINUX
+    if (m_output == &m_output_default)
+    {
+        gpio_reset_pin(CONFIG_BLINK_GPIO);
+        gpio_set_direction(CONFIG_BLINK_GPIO, GPIO_MODE_OUTPUT);
+    }
+#endif
+
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &m_timer));
+    prj_led_seq_start(&m_seq, NULL);
+
+    portENTER_CRITICAL(&m_lock);
+    m_ready = true;
+    led_heap_check();
+    led_update();
+    led_step();
+    portEXIT_CRITICAL(&m_lock);
+
+    return PRJ_SUCCESS;
+}
+
+prj_status_t prj_led_deinit (void)
+{
+    if (!m_ready)
+    {
+        ESP_LOGW(PRJ_LED_TAG, "led deinit: not initialized");
+        return PRJ_ERROR_INVALID_STATE;
+    }
+
+    /* A callback already waiting for the lock sees this and does not re-arm the timer */
+    portENTER_CRITICAL(&m_lock);
+    m_ready = false;
+    esp_timer_stop(m_timer);
+    portEXIT_CRITICAL(&m_lock);
+
+    ESP_ERROR_CHECK(esp_timer_delete(m_timer));
+    m_timer = NULL;
+
+    if (m_output->level_set != NULL)
+    {
+        m_output->level_set(false);
+    }
+
+    return PRJ_SUCCESS;
+}
+
+void prj_led_state_set (const prj_led_state_t state, const prj_bool_t active)
+{
+    const prj_led_pattern_t *p_pattern = NULL;
+
+    if (state >= PRJ_LED_STATE_MAX)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+
+    if (active)
+    {
+        m_states |= (1U << state);
+    }
+    else
+    {
+        m_states &= ~(1U << state);
+    }
+
+    p_pattern = m_seq.p_pattern;
+    led_update();
+
+    /* Only a new winner interrupts the running pattern */
+    if (m_ready && (m_seq.p_pattern != p_pattern))
+    {
+        led_step();
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    return;
+}
+
+const prj_led_pattern_t *prj_led_pattern_get (const prj_led_state_t state)
+{
+    return (state < PRJ_LED_STATE_MAX) ? &m_patterns[state] : NULL;
+}
+
+void prj_led_output_set (const prj_led_output_t *const p_output)
+{
+    m_output = (p_output != NULL) ? p_output : &m_output_default;
+
+    return;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void led_timer_cb (void *p_arg)
+{
+    const prj_led_pattern_t *p_pattern = NULL;
+
+    portENTER_CRITICAL(&m_lock);
+
+    if (m_ready)
+    {
+        p_pattern = m_seq.p_pattern;
+        led_heap_check();
+        led_update();
+
+        /* A held level only woke us for the heap check, do not replay it */
+        if ((m_seq.p_pattern != p_pattern) || ((m_seq.p_pattern != NULL) && (m_seq.index < m_seq.p_pattern->count)))
+        {
+            led_step();
+        }
+        else
+        {
+            esp_timer_start_once(m_timer, PRJ_LED_HEAP_CHECK_MS * PRJ_LED_US_PER_MS);
+        }
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    return;
+}
+
+/* Called with m_lock held, restarts the sequencer if another state wins */
+static void led_update (void)
+{
+    const prj_led_pattern_t *p_pattern = NULL;
+
+    if (m_states != 0U)
+    {
+        p_pattern = &m_patterns[__builtin_ctz(m_states)];
+    }
+
+    if (p_pattern != m_seq.p_pattern)
+    {
+        prj_led_seq_start(&m_seq, p_pattern);
+    }
+
+    return;
+}
+
+/* Called with m_lock held, shows the next step and arms the timer for the one after */
+static void led_step (void)
+{
+    const prj_led_seq_step_t step = prj_led_seq_next(&m_seq);
+    prj_u32_t hold_ms = step.hold_ms;
+
+    if (m_output->level_set != NULL)
+    {
+        m_output->level_set(step.on);
+    }
+
+    if ((hold_ms == 0U) && PRJ_LED_HEAP_CHECK)
+    {
+        hold_ms = PRJ_LED_HEAP_CHECK_MS;
+    }
+
+    esp_timer_stop(m_timer);
+
+    if (hold_ms != 0U)
+    {
+        esp_timer_start_once(m_timer, (prj_u64_t)hold_ms * PRJ_LED_US_PER_MS);
+    }
+
+    return;
+}
+
+/* Called with m_lock held */
+static void led_heap_check (void)
+{
+#if PRJ_LED_HEAP_CHECK
+    const prj_size_t free_size = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+    if (free_size < CONFIG_PRJ_LED_LOW_HEAP_BYTES)
+    {
+        m_states |= (1U << PRJ_LED_STATE_LOW_HEAP);
+    }
+    else if (free_size > (CONFIG_PRJ_LED_LOW_HEAP_BYTES + PRJ_LED_HEAP_HYST))
+    {
+        m_states &= ~(1U << PRJ_LED_STATE_LOW_HEAP);
+    }
+#endif
+
+    return;
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
+static void led_gpio_level_set (const prj_bool_t on)
+{
+    gpio_set_level(CONFIG_BLINK_GPIO, on ? PRJ_LED_ON_LEVEL : PRJ_LED_OFF_LEVEL);
+
+    return;
+}
+#endif
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
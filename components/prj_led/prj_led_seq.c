@@ -0,0 +1,77 @@
+/**
+ * @file prj_led_seq.c
+ * @date 06/02/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "prj_led_seq.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void prj_led_seq_start (prj_led_seq_t *const p_seq, const prj_led_pattern_t *const p_pattern)
+{
+    p_seq->p_pattern = p_pattern;
+    p_seq->index = 0U;
+
+    return;
+}
+
+prj_led_seq_step_t prj_led_seq_next (prj_led_seq_t *const p_seq)
+{
+    const prj_led_pattern_t *const p_pattern = p_seq->p_pattern;
+    prj_led_seq_step_t step = {0};
+
+    if ((p_pattern == NULL) || (p_pattern->count == 0U))
+    {
+        return step;
+    }
+
+    /* A finished one-shot pattern keeps its last level */
+    if (p_seq->index >= p_pattern->count)
+    {
+        step.on = (((p_pattern->count - 1U) & 1U) == 0U);
+        return step;
+    }
+
+    step.on = ((p_seq->index & 1U) == 0U);
+    step.hold_ms = p_pattern->p_steps_ms[p_seq->index];
+    p_seq->index++;
+
+    if (p_seq->index >= p_pattern->count)
+    {
+        if (p_pattern->repeat)
+        {
+            p_seq->index = 0U;
+        }
+        else
+        {
+            step.hold_ms = 0U;
+        }
+    }
+
+    return step;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,129 @@
+/**
+ * @file prj_log.h
+ * @date 05/22/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef PRJ_LOG_H
+#define PRJ_LOG_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "prj_common.h"
+#include <inttypes.h>
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_LOG_TAG      "PRJ_LOG"
+#define PRJ_LOG_ARGS_MAX (4U)
+
+/**
+ * Format table: id, tag, level, format.
+ * Arguments are stored as 32-bit words, so formats may only use 32-bit conversions (PRIu32, PRId32, PRIx32).
+ */
+#define PRJ_LOG_FMT_TABLE(X)                                                                                           \
+    X(WIFI_STA_DISCONNECTED, PRJ_LOG_TAG_WIFI_STA,  ESP_LOG_INFO, "wifi sta event handler: disconnected, reason %" PRIu32) \
+    X(WIFI_STA_GOT_IP,       PRJ_LOG_TAG_WIFI_STA,  ESP_LOG_INFO, "wifi sta event handler: got ip:%" PRIu32 ".%" PRIu32 ".%" PRIu32 ".%" PRIu32) \
+    X(WIFI_STA_LOST_IP,      PRJ_LOG_TAG_WIFI_STA,  ESP_LOG_INFO, "wifi sta event handler: lost ip")                    \
+    X(WIFI_STA_RETRY,        PRJ_LOG_TAG_WIFI_STA,  ESP_LOG_INFO, "wifi sta reconnect: retry in %" PRIu32 " ms")        \
+    X(WIFI_STA_CACHE_MISS,   PRJ_LOG_TAG_WIFI_STA,  ESP_LOG_INFO, "wifi sta cache: cached ap not reachable, falling back to full scan") \
+    X(WIFI_STA_ROAM,         PRJ_LOG_TAG_WIFI_STA,  ESP_LOG_INFO, "wifi sta roam: moving to ap ..:%02" PRIx32 " on channel %" PRIu32 " at %" PRId32 " dBm") \
+    X(WIFI_STA_ROAM_MISS,    PRJ_LOG_TAG_WIFI_STA,  ESP_LOG_INFO, "wifi sta roam: pinned ap not reachable, letting the driver pick") \
+    X(TIME_SYNC_SCHEDULE,    PRJ_LOG_TAG_TIME_SYNC, ESP_LOG_INFO, "time sync background: drift %" PRId32 " ppb, next sync in %" PRIu32 " s")
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/**
+ * @brief Queue a binary log record, e.g. PRJ_LOG(WIFI_STA_RETRY, delay_ms).
+ *
+ * Only copies up to PRJ_LOG_ARGS_MAX words into the ring, the text is rendered later.
+ */
+#define PRJ_LOG(id, ...)                                                                                  \
+    do                                                                                                    \
+    {                                                                                                     \
+        const prj_u32_t prj_log_args[] = {0U, ##__VA_ARGS__};                                           \
+        prj_log_write(PRJ_LOG_FMT_##id, &prj_log_args[1], (sizeof(prj_log_args) / sizeof(prj_log_args[0])) - 1U); \
+    } while (0)
+
+/**
+ * @brief Split an esp_ip4_addr_t address into four PRJ_LOG arguments.
+ */
+#define PRJ_LOG_IP4(addr) ((addr) & 0xFFU), (((addr) >> 8) & 0xFFU), (((addr) >> 16) & 0xFFU), (((addr) >> 24) & 0xFFU)
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef enum
+{
+    PRJ_LOG_TAG_WIFI_STA = 0,
+    PRJ_LOG_TAG_TIME_SYNC,
+    PRJ_LOG_TAG_MAX,
+} prj_log_tag_t;
+
+typedef enum
+{
+#define PRJ_LOG_FMT_ENUM(id, tag, level, fmt) PRJ_LOG_FMT_##id,
+    PRJ_LOG_FMT_TABLE(PRJ_LOG_FMT_ENUM)
+#undef PRJ_LOG_FMT_ENUM
+    PRJ_LOG_FMT_MAX,
+} prj_log_fmt_t;
+
+typedef struct
+{
+    prj_u32_t timestamp_ms;
+    prj_u16_t fmt_id;
+    prj_u8_t tag_id;
+    prj_u8_t argc;
+    prj_u32_t args[PRJ_LOG_ARGS_MAX];
+} prj_log_record_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/**
+ * @brief Initialize the ring and start the render task.
+ *
+ * Dumps the records left in the ring first if the previous reset was a crash. Call early in app_main,
+ * records written before are dropped.
+ *
+ * @return PRJ_SUCCESS or PRJ_ERROR_RESOURCES.
+ */
+prj_status_t prj_log_init (void);
+
+/**
+ * @brief Render the pending records and stop the render task.
+ *
+ * Records written afterwards are dropped until the next prj_log_init().
+ *
+ * @return PRJ_SUCCESS or PRJ_ERROR_INVALID_STATE if not initialized.
+ */
+prj_status_t prj_log_deinit (void);
+
+/**
+ * @brief Queue a record. Lock-free and safe for several producers, drops the record if the ring is full.
+ */
+void prj_log_write (const prj_log_fmt_t fmt_id, const prj_u32_t *const p_args, const prj_u32_t argc);
+
+/**
+ * @brief Take the oldest pending record. Single consumer only.
+ *
+ * @return true if a record was taken.
+ */
+prj_bool_t prj_log_read (prj_log_record_t *const p_record);
+
+/**
+ * @brief Render a record into text without the ESP log prefix.
+ *
+ * @return Number of characters written, as snprintf().
+ */
+prj_i32_t prj_log_render (const prj_log_record_t *const p_record, prj_char_t *const p_buf, const prj_size_t size);
+
+/**
+ * @brief Number of records dropped because the ring was full.
+ */
+prj_u32_t prj_log_dropped (void);
+#endif /* PRJ_LOG_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
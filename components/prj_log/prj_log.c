@@ -0,0 +1,350 @@
+/**
+ * @file prj_log.c
+ * @date 05/22/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "prj_log.h"
+
+#include <stdatomic.h>
+#include "esp_attr.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_system.h"
+#endif
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_LOG_MAGIC        (0x504C4731U) /* "PLG1" */
+#define PRJ_LOG_RING_SIZE    (CONFIG_PRJ_LOG_RING_SIZE)
+#define PRJ_LOG_RING_MASK    (PRJ_LOG_RING_SIZE - 1U)
+#define PRJ_LOG_TEXT_SIZE    (160U)
+#define PRJ_LOG_TASK_NAME    "prj_log"
+#define PRJ_LOG_TASK_STACK   (3072U)
+#define PRJ_LOG_TASK_PRIO    (1U)
+#define PRJ_LOG_STOP_POLL_MS (10U)
+
+_Static_assert((PRJ_LOG_RING_SIZE & PRJ_LOG_RING_MASK) == 0U, "CONFIG_PRJ_LOG_RING_SIZE must be a power of two");
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    prj_log_tag_t tag;
+    esp_log_level_t level;
+    const prj_char_t *p_fmt;
+} log_fmt_desc_t;
+
+typedef struct
+{
+    _Atomic prj_u32_t seq; /*!< pos + 1 when written, pos + ring size when consumed */
+    prj_log_record_t record;
+} log_slot_t;
+
+typedef struct
+{
+    prj_u32_t magic;
+    _Atomic prj_u32_t head; /*!< Next position to write */
+    prj_u32_t tail;         /*!< Next position to read, consumer only */
+    log_slot_t slots[PRJ_LOG_RING_SIZE];
+} log_ring_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void log_crash_dump (void);
+static void log_emit (const prj_log_record_t *const p_record, const prj_char_t *const p_prefix);
+static void log_task (void *p_arg);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+/* No-init RAM keeps the ring across a panic reset */
+static __NOINIT_ATTR log_ring_t m_ring;
+
+static prj_bool_t m_ready = false;
+static _Atomic prj_u32_t m_dropped = 0U;
+static StaticTask_t m_task_buf;
+static StackType_t m_task_stack[PRJ_LOG_TASK_STACK];
+static TaskHandle_t m_task = NULL;
+static volatile prj_bool_t m_stop = false;
+static volatile prj_bool_t m_stopped = false;
+
+static const prj_char_t *const m_tag_names[PRJ_LOG_TAG_MAX] = {
+    "WIFI_STA",
+    "TIME_SYNC",
+};
+
+static const log_fmt_desc_t m_fmt_table[PRJ_LOG_FMT_MAX] = {
+#define PRJ_LOG_FMT_DESC(id, tag, level, fmt) [PRJ_LOG_FMT_##id] = {tag, level, fmt},
+    PRJ_LOG_FMT_TABLE(PRJ_LOG_FMT_DESC)
+#undef PRJ_LOG_FMT_DESC
+};
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+prj_status_t prj_log_init (void)
+{
+    if (m_ready)
+    {
+        return PRJ_SUCCESS;
+    }
+
+    log_crash_dump();
+
+    m_ring.magic = PRJ_LOG_MAGIC;
+    m_ring.tail = 0U;
+    atomic_store_explicit(&m_ring.head, 0U, memory_order_relaxed);
+
+    for (prj_u32_t i = 0U; i < PRJ_LOG_RING_SIZE; i++)
+    {
+        atomic_store_explicit(&m_ring.slots[i].seq, i, memory_order_relaxed);
+    }
+
+    atomic_thread_fence(memory_order_release);
+    m_ready = true;
+    m_stop = false;
+    m_stopped = false;
+
+    m_task = xTaskCreateStatic(log_task, PRJ_LOG_TASK_NAME, PRJ_LOG_TASK_STACK, NULL, PRJ_LOG_TASK_PRIO,
+                               m_task_stack, &m_task_buf);
+
+    if (m_task == NULL)
+    {
+        ESP_LOGE(PRJ_LOG_TAG, "prj log init: failed to create render task");
+        return PRJ_ERROR_RESOURCES;
+    }
+
+    return PRJ_SUCCESS;
+}
+
+prj_status_t prj_log_deinit (void)
+{
+    if (!m_ready)
+    {
+        return PRJ_ERROR_INVALID_STATE;
+    }
+
+    if (m_task != NULL)
+    {
+        m_stop = true;
+        xTaskNotifyGive(m_task);
+
+        /* The task renders what is pending, then suspends itself. Its static memory is reused on the next init */
+        while (!m_stopped || (eTaskGetState(m_task) != eSuspended))
+        {
+            vTaskDelay(pdMS_TO_TICKS(PRJ_LOG_STOP_POLL_MS));
+        }
+
+        vTaskDelete(m_task);
+        m_task = NULL;
+    }
+
+    m_ready = false;
+
+    return PRJ_SUCCESS;
+}
+
+void prj_log_write (const prj_log_fmt_t fmt_id, const prj_u32_t *const p_args, const prj_u32_t argc)
+{
+    log_slot_t *p_slot = NULL;
+    prj_u32_t pos = 0U;
+    prj_u32_t seq = 0U;
+    prj_i32_t diff = 0;
+
+    if (!m_ready || (fmt_id >= PRJ_LOG_FMT_MAX))
+    {
+        atomic_fetch_add_explicit(&m_dropped, 1U, memory_order_relaxed);
+        return;
+    }
+
+    /* Bounded MPMC queue with per-slot sequence numbers: claim a slot with a CAS on head */
+    pos = atomic_load_explicit(&m_ring.head, memory_order_relaxed);
+
+    for (;;)
+    {
+        p_slot = &m_ring.slots[pos & PRJ_LOG_RING_MASK];
+        seq = atomic_load_explicit(&p_slot->seq, memory_order_acquire);
+        diff = (prj_i32_t)(seq - pos);
+
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&m_ring.head, &pos, pos + 1U, memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            atomic_fetch_add_explicit(&m_dropped, 1U, memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            pos = atomic_load_explicit(&m_ring.head, memory_order_relaxed);
+        }
+    }
+
+    p_slot->record.timestamp_ms = (prj_u32_t)(esp_timer_get_time() / 1000);
+    p_slot->record.fmt_id = (prj_u16_t)fmt_id;
+    p_slot->record.tag_id = (prj_u8_t)m_fmt_table[fmt_id].tag;
+    p_slot->record.argc = (prj_u8_t)((argc < PRJ_LOG_ARGS_MAX) ? argc : PRJ_LOG_ARGS_MAX);
+
+    for (prj_u32_t i = 0U; i < p_slot->record.argc; i++)
+    {
+        p_slot->record.args[i] = p_args[i];
+    }
+
+    atomic_store_explicit(&p_slot->seq, pos + 1U, memory_order_release);
+
+    return;
+}
+
+prj_bool_t prj_log_read (prj_log_record_t *const p_record)
+{
+    log_slot_t *p_slot = NULL;
+    prj_u32_t pos = m_ring.tail;
+
+    if (!m_ready)
+    {
+        return false;
+    }
+
+    p_slot = &m_ring.slots[pos & PRJ_LOG_RING_MASK];
+
+    if (atomic_load_explicit(&p_slot->seq, memory_order_acquire) != (pos + 1U))
+    {
+        return false;
+    }
+
+    *p_record = p_slot->record;
+    atomic_store_explicit(&p_slot->seq, pos + PRJ_LOG_RING_SIZE, memory_order_release);
+    m_ring.tail = pos + 1U;
+
+    return true;
+}
+
+prj_i32_t prj_log_render (const prj_log_record_t *const p_record, prj_char_t *const p_buf, const prj_size_t size)
+{
+    const prj_u32_t *p_args = p_record->args;
+
+    if (p_record->fmt_id >= PRJ_LOG_FMT_MAX)
+    {
+        return snprintf(p_buf, size, "unknown format %u", p_record->fmt_id);
+    }
+
+    /* Unused trailing words are ignored by the format */
+    return snprintf(p_buf, size, m_fmt_table[p_record->fmt_id].p_fmt, p_args[0], p_args[1], p_args[2], p_args[3]);
+}
+
+prj_u32_t prj_log_dropped (void)
+{
+    return atomic_load_explicit(&m_dropped, memory_order_relaxed);
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void log_crash_dump (void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    /* No reset reason and no retained RAM on the host */
+    return;
+#else
+    esp_reset_reason_t reason = esp_reset_reason();
+    prj_u32_t head = 0U;
+    prj_u32_t seq = 0U;
+
+    if ((m_ring.magic != PRJ_LOG_MAGIC) ||
+        ((reason != ESP_RST_PANIC) && (reason != ESP_RST_INT_WDT) && (reason != ESP_RST_TASK_WDT) && (reason != ESP_RST_WDT)))
+    {
+        return;
+    }
+
+    head = atomic_load_explicit(&m_ring.head, memory_order_relaxed);
+    ESP_LOGW(PRJ_LOG_TAG, "prj log: last records before reset reason %d", (int)reason);
+
+    /* Replay the whole history, rendered or not: a slot is valid if its sequence matches its position */
+    for (prj_u32_t pos = (head > PRJ_LOG_RING_SIZE) ? (head - PRJ_LOG_RING_SIZE) : 0U; pos != head; pos++)
+    {
+        seq = atomic_load_explicit(&m_ring.slots[pos & PRJ_LOG_RING_MASK].seq, memory_order_relaxed);
+
+        if ((seq == (pos + 1U)) || (seq == (pos + PRJ_LOG_RING_SIZE)))
+        {
+            log_emit(&m_ring.slots[pos & PRJ_LOG_RING_MASK].record, "crash: ");
+        }
+    }
+
+    return;
+#endif
+}
+
+static void log_emit (const prj_log_record_t *const p_record, const prj_char_t *const p_prefix)
+{
+    static const prj_char_t level_letters[] = {'N', 'E', 'W', 'I', 'D', 'V'};
+    prj_char_t text[PRJ_LOG_TEXT_SIZE] = {0};
+    esp_log_level_t level = ESP_LOG_INFO;
+    const prj_char_t *p_tag = "?";
+
+    if (p_record->fmt_id < PRJ_LOG_FMT_MAX)
+    {
+        level = m_fmt_table[p_record->fmt_id].level;
+    }
+
+    if (p_record->tag_id < PRJ_LOG_TAG_MAX)
+    {
+        p_tag = m_tag_names[p_record->tag_id];
+    }
+
+    prj_log_render(p_record, text, sizeof(text));
+    esp_log_write(level, p_tag, "%c (%" PRIu32 ") %s: %s%s\n",
+                  level_letters[((prj_u32_t)level < sizeof(level_letters)) ? level : ESP_LOG_INFO],
+                  p_record->timestamp_ms, p_tag, p_prefix, text);
+
+    return;
+}
+
+static void log_task (void *p_arg)
+{
+    prj_log_record_t record = {0};
+    prj_u32_t dropped_reported = 0U;
+    prj_u32_t dropped = 0U;
+
+    for (;;)
+    {
+        while (prj_log_read(&record))
+        {
+            log_emit(&record, "");
+        }
+
+        dropped = prj_log_dropped();
+
+        if (dropped != dropped_reported)
+        {
+            ESP_LOGW(PRJ_LOG_TAG, "prj log: %" PRIu32 " records dropped", dropped - dropped_reported);
+            dropped_reported = dropped;
+        }
+
+        if (m_stop)
+        {
+            break;
+        }
+
+        /* Woken early by prj_log_deinit() */
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_PRJ_LOG_FLUSH_PERIOD_MS));
+    }
+
+    m_stopped = true;
+    vTaskSuspend(NULL);
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,132 @@
+/**
+ * @file prj_metrics.h
+ * @date 06/04/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef PRJ_METRICS_H
+#define PRJ_METRICS_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "prj_common.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_METRICS_TAG             "METRICS"
+#define PRJ_METRICS_BIN_VERSION     (1U)
+#define PRJ_METRICS_BIN_HEADER_SIZE (10U) /*!< Version, count, layout id, uptime */
+#define PRJ_METRICS_AGE_NEVER       (-1)  /*!< Age of a metric that was never marked */
+
+/**
+ * Metric table: id, kind, name.
+ * The binary snapshot carries the values in table order, append new metrics at the end of a component block
+ * and let the layout id tell the decoder which table a device runs.
+ */
+#define PRJ_METRICS_TABLE(X)                                                                       \
+    X(WIFI_STA_CONNECTS,       COUNTER, "wifi_sta.connects")       /* Got an IP address */        \
+    X(WIFI_STA_DISCONNECTS,    COUNTER, "wifi_sta.disconnects")    /* Any disconnect */           \
+    X(WIFI_STA_DISC_BEACON,    COUNTER, "wifi_sta.disc_beacon")    /* Beacon timeout */           \
+    X(WIFI_STA_DISC_NO_AP,     COUNTER, "wifi_sta.disc_no_ap")     /* AP not found */             \
+    X(WIFI_STA_DISC_AUTH,      COUNTER, "wifi_sta.disc_auth")      /* Auth or handshake failure */ \
+    X(WIFI_STA_LAST_REASON,    GAUGE,   "wifi_sta.last_reason")    /* wifi_err_reason_t */        \
+    X(WIFI_STA_RETRIES,        COUNTER, "wifi_sta.retries")        /* Reconnects scheduled */     \
+    X(WIFI_STA_CONNECT_MS,     GAUGE,   "wifi_sta.connect_ms")     /* Link down until got IP */   \
+    X(WIFI_STA_RSSI,           GAUGE,   "wifi_sta.rssi_dbm")                                      \
+    X(WIFI_STA_ROAMS,          COUNTER, "wifi_sta.roams")          /* Moves to a stronger AP */   \
+    X(WIFI_STA_ROAM_SCANS,     COUNTER, "wifi_sta.roam_scans")     /* Background scans */         \
+    X(TIME_SYNC_SYNCS,         COUNTER, "time_sync.syncs")                                        \
+    X(TIME_SYNC_FAILS,         COUNTER, "time_sync.fails")                                        \
+    X(TIME_SYNC_RTT_US,        GAUGE,   "time_sync.rtt_us")                                       \
+    X(TIME_SYNC_OFFSET_US,     GAUGE,   "time_sync.offset_us")     /* Saturated to 32 bits */     \
+    X(TIME_SYNC_DRIFT_PPB,     GAUGE,   "time_sync.drift_ppb")                                    \
+    X(TIME_SYNC_LAST,          AGE,     "time_sync.last_s")        /* Seconds since the last sync */
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/**
+ * @brief Update a metric by its table id, e.g. PRJ_METRICS_ADD(WIFI_STA_RETRIES, 1U).
+ */
+#define PRJ_METRICS_ADD(id, delta) prj_metrics_add(PRJ_METRICS_##id, (delta))
+#define PRJ_METRICS_SET(id, value) prj_metrics_set(PRJ_METRICS_##id, (value))
+#define PRJ_METRICS_MARK(id)       prj_metrics_mark(PRJ_METRICS_##id)
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef enum
+{
+    PRJ_METRICS_KIND_COUNTER = 0, /*!< Monotonic, summed over the per-core slots */
+    PRJ_METRICS_KIND_GAUGE,       /*!< Last value set */
+    PRJ_METRICS_KIND_AGE,         /*!< Time of the last mark, reported as seconds since then */
+} prj_metrics_kind_t;
+
+typedef enum
+{
+#define PRJ_METRICS_ENUM(id, kind, name) PRJ_METRICS_##id,
+    PRJ_METRICS_TABLE(PRJ_METRICS_ENUM)
+#undef PRJ_METRICS_ENUM
+    PRJ_METRICS_MAX,
+} prj_metrics_id_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/**
+ * @brief Add to a counter. Lock-free, each core updates its own slot.
+ */
+void prj_metrics_add (const prj_metrics_id_t id, const prj_u32_t delta);
+
+/**
+ * @brief Set a gauge. Lock-free, a single 32-bit store.
+ */
+void prj_metrics_set (const prj_metrics_id_t id, const prj_i32_t value);
+
+/**
+ * @brief Mark an age metric with the current time.
+ */
+void prj_metrics_mark (const prj_metrics_id_t id);
+
+/**
+ * @brief Current value: the counter sum, the gauge or the age in seconds (PRJ_METRICS_AGE_NEVER).
+ */
+prj_i64_t prj_metrics_get (const prj_metrics_id_t id);
+
+/**
+ * @brief Metric name from the table.
+ *
+ * @return Name or NULL for an invalid id.
+ */
+const prj_char_t *prj_metrics_name (const prj_metrics_id_t id);
+
+/**
+ * @brief Serialize all metrics into the compact binary form for the telemetry uplink.
+ *
+ * Layout, little-endian: u8 version, u8 count, u32 layout id, u32 uptime in seconds, then one i32 per
+ * metric in table order. Counters are truncated to their low 32 bits.
+ *
+ * @param p_buf Output buffer, may be NULL with size 0 to query the size.
+ * @param size  Buffer size.
+ *
+ * @return Snapshot size in bytes. Nothing is written if it exceeds size.
+ */
+prj_i32_t prj_metrics_snapshot_bin (prj_u8_t *const p_buf, const prj_size_t size);
+
+/**
+ * @brief Serialize all metrics into a flat JSON object keyed by name, plus "uptime_s".
+ *
+ * @return Number of characters written, as snprintf().
+ */
+prj_i32_t prj_metrics_snapshot_json (prj_char_t *const p_buf, const prj_size_t size);
+
+/**
+ * @brief Register the "metrics [json|bin]" console command. Needs CONFIG_PRJ_METRICS_CONSOLE.
+ *
+ * @return PRJ_SUCCESS or PRJ_ERROR_RESOURCES.
+ */
+prj_status_t prj_metrics_console_register (void);
+#endif /* PRJ_METRICS_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
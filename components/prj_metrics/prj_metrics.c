@@ -0,0 +1,208 @@
+/**
+ * @file prj_metrics.c
+ * @date 06/04/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "prj_metrics.h"
+
+#include <stdatomic.h>
+#include <inttypes.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_METRICS_US_PER_SEC (1000000LL)
+#define PRJ_METRICS_FNV_OFFSET (0x811C9DC5U)
+#define PRJ_METRICS_FNV_PRIME  (0x01000193U)
+
+#if CONFIG_IDF_TARGET_LINUX
+#define PRJ_METRICS_CORE_ID()  (0)
+#else
+#define PRJ_METRICS_CORE_ID()  (xPortGetCoreID())
+#endif
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    prj_metrics_kind_t kind;
+    const prj_char_t *p_name;
+} prj_metrics_desc_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static prj_u32_t metrics_uptime_s (void);
+static prj_u32_t metrics_layout_id (void);
+static void metrics_put_u32 (prj_u8_t *const p_buf, const prj_u32_t value);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static const prj_metrics_desc_t m_desc[PRJ_METRICS_MAX] = {
+#define PRJ_METRICS_DESC(id, kind, name) [PRJ_METRICS_##id] = {PRJ_METRICS_KIND_##kind, name},
+    PRJ_METRICS_TABLE(PRJ_METRICS_DESC)
+#undef PRJ_METRICS_DESC
+};
+
+/* A slot per core, so concurrent updates never contend, summed when read */
+static _Atomic prj_u32_t m_counters[portNUM_PROCESSORS][PRJ_METRICS_MAX];
+/* Gauges, and for ages the uptime second of the mark plus one so 0 means never */
+static _Atomic prj_i32_t m_gauges[PRJ_METRICS_MAX];
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void prj_metrics_add (const prj_metrics_id_t id, const prj_u32_t delta)
+{
+    if (id < PRJ_METRICS_MAX)
+    {
+        atomic_fetch_add_explicit(&m_counters[PRJ_METRICS_CORE_ID()][id], delta, memory_order_relaxed);
+    }
+
+    return;
+}
+
+void prj_metrics_set (const prj_metrics_id_t id, const prj_i32_t value)
+{
+    if (id < PRJ_METRICS_MAX)
+    {
+        atomic_store_explicit(&m_gauges[id], value, memory_order_relaxed);
+    }
+
+    return;
+}
+
+void prj_metrics_mark (const prj_metrics_id_t id)
+{
+    prj_metrics_set(id, (prj_i32_t)metrics_uptime_s() + 1);
+
+    return;
+}
+
+prj_i64_t prj_metrics_get (const prj_metrics_id_t id)
+{
+    prj_u32_t sum = 0U;
+    prj_i32_t value = 0;
+
+    if (id >= PRJ_METRICS_MAX)
+    {
+        return 0;
+    }
+
+    switch (m_desc[id].kind)
+    {
+        case PRJ_METRICS_KIND_COUNTER:
+            for (prj_size_t core = 0U; core < portNUM_PROCESSORS; core++)
+            {
+                sum += atomic_load_explicit(&m_counters[core][id], memory_order_relaxed);
+            }
+            return sum;
+
+        case PRJ_METRICS_KIND_AGE:
+            value = atomic_load_explicit(&m_gauges[id], memory_order_relaxed);
+            return (value == 0) ? PRJ_METRICS_AGE_NEVER : ((prj_i64_t)metrics_uptime_s() - (value - 1));
+
+        default:
+            return atomic_load_explicit(&m_gauges[id], memory_order_relaxed);
+    }
+}
+
+const prj_char_t *prj_metrics_name (const prj_metrics_id_t id)
+{
+    return (id < PRJ_METRICS_MAX) ? m_desc[id].p_name : NULL;
+}
+
+prj_i32_t prj_metrics_snapshot_bin (prj_u8_t *const p_buf, const prj_size_t size)
+{
+    const prj_size_t total = PRJ_METRICS_BIN_HEADER_SIZE + (PRJ_METRICS_MAX * sizeof(prj_i32_t));
+    prj_u8_t *p_out = p_buf;
+
+    if ((p_buf == NULL) || (size < total))
+    {
+        return (prj_i32_t)total;
+    }
+
+    *p_out++ = (prj_u8_t)PRJ_METRICS_BIN_VERSION;
+    *p_out++ = (prj_u8_t)PRJ_METRICS_MAX;
+    metrics_put_u32(p_out, metrics_layout_id());
+    p_out += sizeof(prj_u32_t);
+    metrics_put_u32(p_out, metrics_uptime_s());
+    p_out += sizeof(prj_u32_t);
+
+    for (prj_size_t i = 0U; i < PRJ_METRICS_MAX; i++)
+    {
+        metrics_put_u32(p_out, (prj_u32_t)prj_metrics_get((prj_metrics_id_t)i));
+        p_out += sizeof(prj_u32_t);
+    }
+
+    return (prj_i32_t)total;
+}
+
+prj_i32_t prj_metrics_snapshot_json (prj_char_t *const p_buf, const prj_size_t size)
+{
+    prj_size_t len = 0U;
+    prj_i32_t written = 0;
+
+    /* Like snprintf(), keep counting once the buffer is full so the caller learns the size */
+    written = snprintf(p_buf, size, "{\"uptime_s\":%" PRIu32, metrics_uptime_s());
+    len += (written > 0) ? (prj_size_t)written : 0U;
+
+    for (prj_size_t i = 0U; i < PRJ_METRICS_MAX; i++)
+    {
+        written = snprintf((len < size) ? &p_buf[len] : NULL, (len < size) ? (size - len) : 0U, ",\"%s\":%" PRId64,
+                           m_desc[i].p_name, prj_metrics_get((prj_metrics_id_t)i));
+        len += (written > 0) ? (prj_size_t)written : 0U;
+    }
+
+    written = snprintf((len < size) ? &p_buf[len] : NULL, (len < size) ? (size - len) : 0U, "}");
+    len += (written > 0) ? (prj_size_t)written : 0U;
+
+    return (prj_i32_t)len;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static prj_u32_t metrics_uptime_s (void)
+{
+    return (prj_u32_t)(esp_timer_get_time() / PRJ_METRICS_US_PER_SEC);
+}
+
+/* FNV-1a over the kinds and names, changes whenever the table does */
+static prj_u32_t metrics_layout_id (void)
+{
+    prj_u32_t hash = PRJ_METRICS_FNV_OFFSET;
+
+    for (prj_size_t i = 0U; i < PRJ_METRICS_MAX; i++)
+    {
+        hash = (hash ^ (prj_u32_t)m_desc[i].kind) * PRJ_METRICS_FNV_PRIME;
+
+        for (const prj_char_t *p_c = m_desc[i].p_name; *p_c != '\0'; p_c++)
+        {
+            hash = (hash ^ (prj_u8_t)*p_c) * PRJ_METRICS_FNV_PRIME;
+        }
+    }
+
+    return hash;
+}
+
+static void metrics_put_u32 (prj_u8_t *const p_buf, const prj_u32_t value)
+{
+    p_buf[0] = (prj_u8_t)value;
+    p_buf[1] = (prj_u8_t)(value >> 8);
+    p_buf[2] = (prj_u8_t)(value >> 16);
+    p_buf[3] = (prj_u8_t)(value >> 24);
+
+    return;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
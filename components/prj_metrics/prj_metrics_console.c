@@ -0,0 +1,97 @@
+/**
+ * @file prj_metrics_console.c
+ * @date 06/04/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "prj_metrics.h"
+
+#include <string.h>
+#include <inttypes.h>
+#include "esp_console.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_METRICS_CONSOLE_BUF_SIZE (1024U)
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static int metrics_console_cmd (int argc, char **argv);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+/* Only the console task uses it, keeps the snapshot off its stack */
+static prj_char_t m_buf[PRJ_METRICS_CONSOLE_BUF_SIZE];
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+prj_status_t prj_metrics_console_register (void)
+{
+    const esp_console_cmd_t cmd = {
+        .command = "metrics",
+        .help    = "Print the runtime metrics as a table, as JSON or as the hex encoded binary snapshot",
+        .hint    = "[json|bin]",
+        .func    = metrics_console_cmd,
+    };
+
+    return (esp_console_cmd_register(&cmd) == ESP_OK) ? PRJ_SUCCESS : PRJ_ERROR_RESOURCES;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static int metrics_console_cmd (int argc, char **argv)
+{
+    prj_i32_t len = 0;
+
+    if ((argc > 1) && (strcmp(argv[1], "json") == 0))
+    {
+        len = prj_metrics_snapshot_json(m_buf, sizeof(m_buf));
+        printf("%s%s\n", m_buf, (len >= (prj_i32_t)sizeof(m_buf)) ? " (truncated)" : "");
+    }
+    else if ((argc > 1) && (strcmp(argv[1], "bin") == 0))
+    {
+        len = prj_metrics_snapshot_bin((prj_u8_t *)m_buf, sizeof(m_buf));
+
+        if (len > (prj_i32_t)sizeof(m_buf))
+        {
+            printf("metrics: snapshot of %" PRId32 " bytes does not fit\n", len);
+            return 1;
+        }
+
+        for (prj_i32_t i = 0; i < len; i++)
+        {
+            printf("%02x", (prj_u8_t)m_buf[i]);
+        }
+
+        printf("\n");
+    }
+    else if (argc > 1)
+    {
+        printf("metrics: unknown format '%s'\n", argv[1]);
+        return 1;
+    }
+    else
+    {
+        for (prj_size_t i = 0U; i < PRJ_METRICS_MAX; i++)
+        {
+            printf("%-24s %" PRId64 "\n", prj_metrics_name((prj_metrics_id_t)i), prj_metrics_get((prj_metrics_id_t)i));
+        }
+    }
+
+    return 0;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
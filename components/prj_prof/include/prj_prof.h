@@ -0,0 +1,80 @@
+/**
+ * @file prj_prof.h
+ * @date 05/20/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef PRJ_PROF_H
+#define PRJ_PROF_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "prj_common.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_PROF_TAG "PROF"
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef enum
+{
+    PRJ_PROF_PHASE_NETIF_INIT = 0, /*!< esp_netif_init() */
+    PRJ_PROF_PHASE_WIFI_START,     /*!< esp_wifi_init() until WIFI_EVENT_STA_START */
+    PRJ_PROF_PHASE_ASSOC,          /*!< esp_wifi_connect() until WIFI_EVENT_STA_CONNECTED */
+    PRJ_PROF_PHASE_DHCP,           /*!< WIFI_EVENT_STA_CONNECTED until IP_EVENT_STA_GOT_IP */
+    PRJ_PROF_PHASE_SNTP_REQ,       /*!< Time request until the server answer */
+    PRJ_PROF_PHASE_SNTP_SET,       /*!< Server answer until the clock is corrected and saved */
+    PRJ_PROF_PHASE_MAX,
+} prj_prof_phase_t;
+
+typedef struct
+{
+    prj_u32_t count;  /*!< Number of recorded cycles */
+    prj_u32_t min_us;
+    prj_u32_t max_us;
+    prj_u32_t p50_us; /*!< Percentiles are accurate to about 12% of the value */
+    prj_u32_t p90_us;
+    prj_u32_t p99_us;
+} prj_prof_stats_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/**
+ * @brief Mark the start of a phase.
+ */
+void prj_prof_begin (const prj_prof_phase_t phase);
+
+/**
+ * @brief Mark the end of a phase and add its duration to the histogram.
+ *
+ * Ignored if the phase was not started, so failed attempts do not pollute the statistics.
+ */
+void prj_prof_end (const prj_prof_phase_t phase);
+
+/**
+ * @brief Get the statistics of one phase, accumulated across boot and wake cycles.
+ *
+ * @return PRJ_SUCCESS, PRJ_ERROR_NULL or PRJ_ERROR_INVALID_PARAM.
+ */
+prj_status_t prj_prof_stats_get (const prj_prof_phase_t phase, prj_prof_stats_t *const p_stats);
+
+/**
+ * @brief Print a one-line summary per phase.
+ */
+void prj_prof_summary_print (void);
+
+/**
+ * @brief Drop all accumulated statistics.
+ */
+void prj_prof_reset (void);
+#endif /* PRJ_PROF_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,263 @@
+/**
+ * @file prj_prof.c
+ * @date 05/20/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "prj_prof.h"
+
+#include <string.h>
+#include <inttypes.h>
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_PROF_MAGIC          (0x50524631U) /* "PRF1", bump when the layout changes */
+#define PRJ_PROF_SUB_BITS       (2U)          /* 4 buckets per power of two */
+#define PRJ_PROF_SUB_COUNT      (1U << PRJ_PROF_SUB_BITS)
+#define PRJ_PROF_OCTAVES        (26U)         /* Up to about 67 s */
+#define PRJ_PROF_BUCKETS        (PRJ_PROF_OCTAVES * PRJ_PROF_SUB_COUNT)
+#define PRJ_PROF_COUNT_MAX      (UINT16_MAX)
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    prj_u32_t count;
+    prj_u32_t min_us;
+    prj_u32_t max_us;
+    prj_u16_t buckets[PRJ_PROF_BUCKETS];
+} prof_hist_t;
+
+typedef struct
+{
+    prj_u32_t magic;
+    prof_hist_t hist[PRJ_PROF_PHASE_MAX];
+} prof_store_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void prof_check (void);
+static prj_u32_t prof_bucket (const prj_u32_t value_us);
+static prj_u32_t prof_bucket_value (const prj_u32_t bucket);
+static prj_u32_t prof_percentile (const prof_hist_t *const p_hist, const prj_u32_t percent);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+/* Survives deep sleep and soft resets, so the histograms cover many cycles */
+static RTC_NOINIT_ATTR prof_store_t m_store;
+
+static prj_i64_t m_start_us[PRJ_PROF_PHASE_MAX] = {0};
+static portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+static prj_bool_t m_checked = false;
+
+static const prj_char_t *const m_phase_names[PRJ_PROF_PHASE_MAX] = {
+    "netif_init",
+    "wifi_start",
+    "assoc",
+    "dhcp",
+    "sntp_req",
+    "sntp_set",
+};
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void prj_prof_begin (const prj_prof_phase_t phase)
+{
+    if (phase < PRJ_PROF_PHASE_MAX)
+    {
+        m_start_us[phase] = esp_timer_get_time();
+    }
+
+    return;
+}
+
+void prj_prof_end (const prj_prof_phase_t phase)
+{
+    prj_i64_t now_us = esp_timer_get_time();
+    prj_u32_t duration_us = 0U;
+    prof_hist_t *p_hist = NULL;
+    prj_u32_t bucket = 0U;
+
+    if ((phase >= PRJ_PROF_PHASE_MAX) || (m_start_us[phase] == 0))
+    {
+        return;
+    }
+
+    duration_us = (prj_u32_t)(((now_us - m_start_us[phase]) < UINT32_MAX) ? (now_us - m_start_us[phase]) : UINT32_MAX);
+    bucket = prof_bucket(duration_us);
+    m_start_us[phase] = 0;
+
+    prof_check();
+
+    portENTER_CRITICAL(&m_lock);
+    p_hist = &m_store.hist[phase];
+    p_hist->min_us = ((p_hist->count == 0U) || (duration_us < p_hist->min_us)) ? duration_us : p_hist->min_us;
+    p_hist->max_us = (duration_us > p_hist->max_us) ? duration_us : p_hist->max_us;
+    p_hist->count++;
+
+    if (p_hist->buckets[bucket] < PRJ_PROF_COUNT_MAX)
+    {
+        p_hist->buckets[bucket]++;
+    }
+    portEXIT_CRITICAL(&m_lock);
+
+    return;
+}
+
+prj_status_t prj_prof_stats_get (const prj_prof_phase_t phase, prj_prof_stats_t *const p_stats)
+{
+    prof_hist_t hist = {0};
+
+    if (p_stats == NULL)
+    {
+        return PRJ_ERROR_NULL;
+    }
+
+    if (phase >= PRJ_PROF_PHASE_MAX)
+    {
+        return PRJ_ERROR_INVALID_PARAM;
+    }
+
+    prof_check();
+
+    portENTER_CRITICAL(&m_lock);
+    hist = m_store.hist[phase];
+    portEXIT_CRITICAL(&m_lock);
+
+    p_stats->count = hist.count;
+    p_stats->min_us = hist.min_us;
+    p_stats->max_us = hist.max_us;
+    p_stats->p50_us = prof_percentile(&hist, 50U);
+    p_stats->p90_us = prof_percentile(&hist, 90U);
+    p_stats->p99_us = prof_percentile(&hist, 99U);
+
+    return PRJ_SUCCESS;
+}
+
+void prj_prof_summary_print (void)
+{
+    prj_prof_stats_t stats = {0};
+
+    ESP_LOGI(PRJ_PROF_TAG, "%-10s %6s %9s %9s %9s %9s %9s (us)", "phase", "n", "min", "p50", "p90", "p99", "max");
+
+    for (prj_u32_t i = 0U; i < PRJ_PROF_PHASE_MAX; i++)
+    {
+        prj_prof_stats_get((prj_prof_phase_t)i, &stats);
+        ESP_LOGI(PRJ_PROF_TAG, "%-10s %6" PRIu32 " %9" PRIu32 " %9" PRIu32 " %9" PRIu32 " %9" PRIu32 " %9" PRIu32,
+                 m_phase_names[i], stats.count, stats.min_us, stats.p50_us, stats.p90_us, stats.p99_us, stats.max_us);
+    }
+
+    return;
+}
+
+void prj_prof_reset (void)
+{
+    portENTER_CRITICAL(&m_lock);
+    memset(&m_store, 0, sizeof(m_store));
+    m_store.magic = PRJ_PROF_MAGIC;
+    m_checked = true;
+    portEXIT_CRITICAL(&m_lock);
+
+    return;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void prof_check (void)
+{
+    /* RTC memory holds garbage after power-on */
+    if (!m_checked && (m_store.magic != PRJ_PROF_MAGIC))
+    {
+        prj_prof_reset();
+    }
+
+    m_checked = true;
+
+    return;
+}
+
+static prj_u32_t prof_bucket (const prj_u32_t value_us)
+{
+    prj_u32_t msb = 0U;
+    prj_u32_t bucket = 0U;
+
+    if (value_us < PRJ_PROF_SUB_COUNT)
+    {
+        return value_us;
+    }
+
+    /* Log-linear: the octave picks the bucket group, the next two bits pick the bucket within it */
+    msb = 31U - (prj_u32_t)__builtin_clz(value_us);
+    bucket = ((msb - PRJ_PROF_SUB_BITS + 1U) << PRJ_PROF_SUB_BITS) + ((value_us >> (msb - PRJ_PROF_SUB_BITS)) & (PRJ_PROF_SUB_COUNT - 1U));
+
+    return (bucket < PRJ_PROF_BUCKETS) ? bucket : (PRJ_PROF_BUCKETS - 1U);
+}
+
+static prj_u32_t prof_bucket_value (const prj_u32_t bucket)
+{
+    prj_u32_t shift = 0U;
+    prj_u32_t low = 0U;
+
+    if (bucket < PRJ_PROF_SUB_COUNT)
+    {
+        return bucket;
+    }
+
+    shift = (bucket >> PRJ_PROF_SUB_BITS) - 1U;
+    low = (PRJ_PROF_SUB_COUNT + (bucket & (PRJ_PROF_SUB_COUNT - 1U))) << shift;
+
+    /* Middle of the bucket */
+    return low + ((1U << shift) / 2U);
+}
+
+static prj_u32_t prof_percentile (const prof_hist_t *const p_hist, const prj_u32_t percent)
+{
+    prj_u32_t total = 0U;
+    prj_u32_t rank = 0U;
+    prj_u32_t seen = 0U;
+    prj_u32_t value = 0U;
+
+    for (prj_u32_t i = 0U; i < PRJ_PROF_BUCKETS; i++)
+    {
+        total += p_hist->buckets[i];
+    }
+
+    if (total == 0U)
+    {
+        return 0U;
+    }
+
+    rank = ((total * percent) + 99U) / 100U;
+
+    for (prj_u32_t i = 0U; i < PRJ_PROF_BUCKETS; i++)
+    {
+        seen += p_hist->buckets[i];
+
+        if (seen >= rank)
+        {
+            value = prof_bucket_value(i);
+            break;
+        }
+    }
+
+    /* Bucket midpoints can fall outside the observed range */
+    value = (value < p_hist->min_us) ? p_hist->min_us : value;
+    value = (value > p_hist->max_us) ? p_hist->max_us : value;
+
+    return value;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
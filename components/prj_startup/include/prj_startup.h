@@ -0,0 +1,110 @@
+/**
+ * @file prj_startup.h
+ * @date 05/28/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef PRJ_STARTUP_H
+#define PRJ_STARTUP_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "prj_common.h"
+#include "freertos/FreeRTOS.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_STARTUP_TAG       "STARTUP"
+
+#define PRJ_STARTUP_ENTRY_MAX (24U) /*!< One event group bit per entry */
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/**
+ * @brief Dependency mask bit of the entry at the given table index.
+ */
+#define PRJ_STARTUP_DEP(index) (1UL << (index))
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef prj_status_t (*prj_startup_init_t)(void);
+
+typedef struct
+{
+    const prj_char_t *p_name;
+    prj_startup_init_t init;
+    prj_startup_init_t deinit; /*!< Undoes init, NULL if the component stays up */
+    prj_u32_t deps;            /*!< PRJ_STARTUP_DEP() of every entry that must be initialized first */
+    BaseType_t core;           /*!< Core to run the init on, tskNO_AFFINITY for any */
+} prj_startup_entry_t;
+
+typedef struct
+{
+    prj_status_t status;  /*!< Init result, PRJ_ERROR_INVALID_STATE if skipped for a failed dependency */
+    prj_u32_t start_us;   /*!< Start of the init, relative to the start of the run */
+    prj_u32_t init_us;    /*!< Time spent in the init */
+    BaseType_t core;      /*!< Core the init ran on */
+    prj_i32_t heap_used;  /*!< Heap kept by the init, includes what inits on the other core took meanwhile */
+    prj_u32_t heap_peak;  /*!< Heap high-water during the init, the net use if the boot low mark was not beaten */
+    prj_i32_t heap_freed; /*!< Heap returned by the deinit */
+} prj_startup_report_t;
+
+typedef struct
+{
+    prj_u32_t free_size;     /*!< Free heap now */
+    prj_u32_t min_free_size; /*!< Lowest free heap since boot */
+    prj_u32_t largest_block; /*!< Largest free block, the gap to free_size is the fragmentation */
+} prj_startup_heap_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/**
+ * @brief Run the init functions of a startup table, in dependency order and in parallel on all cores.
+ *
+ * Every core gets a worker task that takes the next entry whose dependencies are done. An entry whose
+ * dependency failed is skipped, so are its own dependents. Returns when every entry is done.
+ *
+ * @param p_entries Startup table, dependencies must point to lower indices.
+ * @param count     Number of entries, up to PRJ_STARTUP_ENTRY_MAX.
+ * @param p_reports Optional output, one report per entry.
+ *
+ * @return PRJ_SUCCESS if every init succeeded, PRJ_ERROR_INTERNAL if any failed or was skipped,
+ *         PRJ_ERROR_NULL, PRJ_ERROR_INVALID_PARAM or PRJ_ERROR_BUSY.
+ */
+prj_status_t prj_startup_run (const prj_startup_entry_t *const p_entries, const prj_u8_t count,
+                              prj_startup_report_t *const p_reports);
+
+/**
+ * @brief Run the deinit functions of the entries that initialized, in reverse table order.
+ *
+ * Runs on the calling task, one entry at a time, and warns about every component that did not give
+ * back the heap its init took.
+ *
+ * @param p_entries Startup table given to prj_startup_run().
+ * @param count     Number of entries.
+ * @param p_reports Reports filled by prj_startup_run(), NULL if it was given NULL too.
+ *
+ * @return PRJ_SUCCESS, PRJ_ERROR_INTERNAL if any deinit failed, PRJ_ERROR_NULL or PRJ_ERROR_INVALID_PARAM.
+ */
+prj_status_t prj_startup_deinit (const prj_startup_entry_t *const p_entries, const prj_u8_t count,
+                                 prj_startup_report_t *const p_reports);
+
+/**
+ * @brief Get the free, lowest free and largest free block sizes of the 8-bit heap.
+ *
+ * @return PRJ_SUCCESS or PRJ_ERROR_NULL.
+ */
+prj_status_t prj_startup_heap_get (prj_startup_heap_t *const p_heap);
+
+/**
+ * @brief Print one line per entry with time and heap use, then the totals and the heap fragmentation.
+ */
+void prj_startup_report_print (const prj_startup_entry_t *const p_entries, const prj_u8_t count,
+                               const prj_startup_report_t *const p_reports);
+#endif /* PRJ_STARTUP_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
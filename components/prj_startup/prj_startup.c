@@ -0,0 +1,405 @@
+/**
+ * @file prj_startup.c
+ * @date 05/28/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "prj_startup.h"
+
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_heap_caps.h"
+#endif
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_STARTUP_TASK_NAME    "prj_startup"
+#define PRJ_STARTUP_TASK_STACK   (4096U)
+#define PRJ_STARTUP_TASK_PRIO    (5U)
+#define PRJ_STARTUP_STOP_POLL_MS (1U)
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    const prj_startup_entry_t *p_entries;
+    prj_startup_report_t *p_reports;
+    prj_u8_t count;
+    prj_u32_t all;     /*!< Bit of every entry */
+    prj_u32_t claimed; /*!< Entries taken by a worker */
+    prj_u32_t done;    /*!< Entries finished, mirrored in the event group */
+    prj_u32_t failed;  /*!< Entries failed or skipped */
+    prj_i64_t start_us;
+    TaskHandle_t owner;
+    EventGroupHandle_t event_group;
+} startup_run_t;
+
+typedef struct
+{
+    StaticTask_t task_buf;
+    StackType_t stack[PRJ_STARTUP_TASK_STACK];
+    TaskHandle_t task;
+    volatile prj_bool_t stopped;
+} startup_worker_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static prj_status_t startup_check (const prj_startup_entry_t *const p_entries, const prj_u8_t count);
+static prj_bool_t startup_claim (const BaseType_t core, prj_u8_t *const p_index, prj_bool_t *const p_skip, prj_u32_t *const p_wait);
+static void startup_task (void *p_arg);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static startup_run_t m_run = {0};
+static portMUX_TYPE m_run_lock = portMUX_INITIALIZER_UNLOCKED;
+static StaticEventGroup_t m_event_group_buf;
+static startup_worker_t m_workers[portNUM_PROCESSORS];
+static prj_startup_report_t m_reports[PRJ_STARTUP_ENTRY_MAX];
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+prj_status_t prj_startup_run (const prj_startup_entry_t *const p_entries, const prj_u8_t count,
+                              prj_startup_report_t *const p_reports)
+{
+    prj_status_t status = PRJ_SUCCESS;
+
+    status = startup_check(p_entries, count);
+
+    if (status != PRJ_SUCCESS)
+    {
+        return status;
+    }
+
+    if (m_run.owner != NULL)
+    {
+        ESP_LOGW(PRJ_STARTUP_TAG, "startup run: already running");
+        return PRJ_ERROR_BUSY;
+    }
+
+    m_run.p_entries   = p_entries;
+    m_run.p_reports   = (p_reports != NULL) ? p_reports : m_reports;
+    m_run.count       = count;
+    m_run.all         = (1UL << count) - 1U;
+    m_run.claimed     = 0U;
+    m_run.done        = 0U;
+    m_run.failed      = 0U;
+    m_run.owner       = xTaskGetCurrentTaskHandle();
+    m_run.event_group = xEventGroupCreateStatic(&m_event_group_buf);
+    m_run.start_us    = esp_timer_get_time();
+
+    /* Drop a notification left over from before, each worker gives one when it runs out of work */
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    /* Static workers: nothing is left behind in the heap between the component allocations */
+    for (BaseType_t core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        m_workers[core].stopped = false;
+        m_workers[core].task = xTaskCreateStaticPinnedToCore(startup_task, PRJ_STARTUP_TASK_NAME, PRJ_STARTUP_TASK_STACK,
+                                                             &m_workers[core], PRJ_STARTUP_TASK_PRIO, m_workers[core].stack,
+                                                             &m_workers[core].task_buf, core);
+    }
+
+    for (BaseType_t core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+    }
+
+    /* Workers suspend themselves, delete them only then so the static memory can be reused */
+    for (BaseType_t core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        while (!m_workers[core].stopped || (eTaskGetState(m_workers[core].task) != eSuspended))
+        {
+            vTaskDelay(pdMS_TO_TICKS(PRJ_STARTUP_STOP_POLL_MS));
+        }
+
+        vTaskDelete(m_workers[core].task);
+        m_workers[core].task = NULL;
+    }
+
+    vEventGroupDelete(m_run.event_group);
+
+    status = (m_run.failed == 0U) ? PRJ_SUCCESS : PRJ_ERROR_INTERNAL;
+    m_run.owner = NULL;
+
+    return status;
+}
+
+prj_status_t prj_startup_deinit (const prj_startup_entry_t *const p_entries, const prj_u8_t count,
+                                 prj_startup_report_t *const p_reports)
+{
+    prj_startup_report_t *p_report = p_reports;
+    prj_startup_heap_t before = {0};
+    prj_startup_heap_t after = {0};
+    prj_status_t status = PRJ_SUCCESS;
+    prj_status_t result = PRJ_SUCCESS;
+
+    status = startup_check(p_entries, count);
+
+    if (status != PRJ_SUCCESS)
+    {
+        return status;
+    }
+
+    if (p_report == NULL)
+    {
+        p_report = m_reports;
+    }
+
+    /* Dependencies point to lower indices, so the reverse order never pulls the rug from under anyone */
+    for (prj_u8_t i = count; i > 0U; i--)
+    {
+        if ((p_report[i - 1U].status != PRJ_SUCCESS) || (p_entries[i - 1U].deinit == NULL))
+        {
+            continue;
+        }
+
+        prj_startup_heap_get(&before);
+        status = p_entries[i - 1U].deinit();
+        prj_startup_heap_get(&after);
+
+        p_report[i - 1U].heap_freed = (prj_i32_t)(after.free_size - before.free_size);
+
+        if (status != PRJ_SUCCESS)
+        {
+            ESP_LOGE(PRJ_STARTUP_TAG, "startup deinit: %s failed, status 0x%" PRIx32, p_entries[i - 1U].p_name, status);
+            result = PRJ_ERROR_INTERNAL;
+        }
+        else if (p_report[i - 1U].heap_freed < p_report[i - 1U].heap_used)
+        {
+            ESP_LOGW(PRJ_STARTUP_TAG, "startup deinit: %s kept %" PRId32 " bytes of heap", p_entries[i - 1U].p_name,
+                     p_report[i - 1U].heap_used - p_report[i - 1U].heap_freed);
+        }
+
+        /* Deinitialized, so a second deinit skips it */
+        p_report[i - 1U].status = PRJ_ERROR_INVALID_STATE;
+    }
+
+    return result;
+}
+
+prj_status_t prj_startup_heap_get (prj_startup_heap_t *const p_heap)
+{
+    if (p_heap == NULL)
+    {
+        return PRJ_ERROR_NULL;
+    }
+
+#if CONFIG_IDF_TARGET_LINUX
+    /* The host heap has no capabilities API */
+    p_heap->free_size = 0U;
+    p_heap->min_free_size = 0U;
+    p_heap->largest_block = 0U;
+#else
+    p_heap->free_size = (prj_u32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    p_heap->min_free_size = (prj_u32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    p_heap->largest_block = (prj_u32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#endif
+
+    return PRJ_SUCCESS;
+}
+
+void prj_startup_report_print (const prj_startup_entry_t *const p_entries, const prj_u8_t count,
+                               const prj_startup_report_t *const p_reports)
+{
+    const prj_startup_report_t *p_report = p_reports;
+    prj_startup_heap_t heap = {0};
+    prj_u32_t end_us = 0U;
+    prj_u32_t sum_us = 0U;
+
+    if ((p_entries == NULL) || (count > PRJ_STARTUP_ENTRY_MAX))
+    {
+        return;
+    }
+
+    if (p_report == NULL)
+    {
+        p_report = m_reports;
+    }
+
+    for (prj_u8_t i = 0U; i < count; i++)
+    {
+        ESP_LOGI(PRJ_STARTUP_TAG, "startup report: %-12s core %d start %8" PRIu32 " us init %8" PRIu32 " us heap %+7" PRId32
+                 " peak %7" PRIu32 "%s",
+                 p_entries[i].p_name, (int)p_report[i].core, p_report[i].start_us, p_report[i].init_us,
+                 p_report[i].heap_used, p_report[i].heap_peak, (p_report[i].status == PRJ_SUCCESS) ? "" : " FAILED");
+
+        sum_us += p_report[i].init_us;
+
+        if ((p_report[i].start_us + p_report[i].init_us) > end_us)
+        {
+            end_us = p_report[i].start_us + p_report[i].init_us;
+        }
+    }
+
+    ESP_LOGI(PRJ_STARTUP_TAG, "startup report: total %" PRIu32 " us, sequential %" PRIu32 " us", end_us, sum_us);
+
+    prj_startup_heap_get(&heap);
+    ESP_LOGI(PRJ_STARTUP_TAG, "startup report: heap free %" PRIu32 " min %" PRIu32 " largest %" PRIu32 " fragmentation %" PRIu32 "%%",
+             heap.free_size, heap.min_free_size, heap.largest_block,
+             (heap.free_size > 0U) ? (100U - (prj_u32_t)(((prj_u64_t)heap.largest_block * 100U) / heap.free_size)) : 0U);
+
+    return;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static prj_status_t startup_check (const prj_startup_entry_t *const p_entries, const prj_u8_t count)
+{
+    if (p_entries == NULL)
+    {
+        return PRJ_ERROR_NULL;
+    }
+
+    if ((count == 0U) || (count > PRJ_STARTUP_ENTRY_MAX))
+    {
+        return PRJ_ERROR_INVALID_PARAM;
+    }
+
+    for (prj_u8_t i = 0U; i < count; i++)
+    {
+        /* Dependencies on earlier entries only, so the table can never hold a cycle */
+        if ((p_entries[i].init == NULL) || ((p_entries[i].deps >> i) != 0U))
+        {
+            ESP_LOGE(PRJ_STARTUP_TAG, "startup check: bad entry %u", (unsigned)i);
+            return PRJ_ERROR_INVALID_PARAM;
+        }
+
+        if ((p_entries[i].core != tskNO_AFFINITY) && ((p_entries[i].core < 0) || (p_entries[i].core >= portNUM_PROCESSORS)))
+        {
+            ESP_LOGE(PRJ_STARTUP_TAG, "startup check: bad core for entry %u", (unsigned)i);
+            return PRJ_ERROR_INVALID_PARAM;
+        }
+    }
+
+    return PRJ_SUCCESS;
+}
+
+static prj_bool_t startup_claim (const BaseType_t core, prj_u8_t *const p_index, prj_bool_t *const p_skip, prj_u32_t *const p_wait)
+{
+    const prj_startup_entry_t *p_entry = NULL;
+    prj_bool_t claimed = false;
+    prj_u32_t pending = 0U;
+
+    portENTER_CRITICAL(&m_run_lock);
+
+    for (prj_u8_t i = 0U; i < m_run.count; i++)
+    {
+        p_entry = &m_run.p_entries[i];
+
+        if (((m_run.claimed & (1UL << i)) != 0U) || ((p_entry->core != tskNO_AFFINITY) && (p_entry->core != core)))
+        {
+            continue;
+        }
+
+        if (!claimed && ((p_entry->deps & ~m_run.done) == 0U))
+        {
+            m_run.claimed |= (1UL << i);
+            *p_index = i;
+            *p_skip = ((p_entry->deps & m_run.failed) != 0U);
+            claimed = true;
+        }
+        else
+        {
+            pending |= (1UL << i);
+        }
+    }
+
+    /* Anything not done yet may unblock a pending entry */
+    *p_wait = (pending != 0U) ? (m_run.all & ~m_run.done) : 0U;
+
+    portEXIT_CRITICAL(&m_run_lock);
+
+    return claimed;
+}
+
+static void startup_task (void *p_arg)
+{
+    startup_worker_t *p_worker = (startup_worker_t *)p_arg;
+    const BaseType_t core = xPortGetCoreID();
+    const prj_startup_entry_t *p_entry = NULL;
+    prj_startup_report_t *p_report = NULL;
+    prj_startup_heap_t before = {0};
+    prj_startup_heap_t after = {0};
+    prj_u8_t index = 0U;
+    prj_bool_t skip = false;
+    prj_u32_t wait = 0U;
+    prj_i64_t start_us = 0;
+
+    for (;;)
+    {
+        if (startup_claim(core, &index, &skip, &wait))
+        {
+            p_entry = &m_run.p_entries[index];
+            p_report = &m_run.p_reports[index];
+            prj_startup_heap_get(&before);
+            start_us = esp_timer_get_time();
+
+            if (skip)
+            {
+                ESP_LOGW(PRJ_STARTUP_TAG, "startup task: %s skipped, dependency failed", p_entry->p_name);
+                p_report->status = PRJ_ERROR_INVALID_STATE;
+            }
+            else
+            {
+                p_report->status = p_entry->init();
+            }
+
+            p_report->init_us  = (prj_u32_t)(esp_timer_get_time() - start_us);
+            p_report->start_us = (prj_u32_t)(start_us - m_run.start_us);
+            p_report->core     = core;
+
+            prj_startup_heap_get(&after);
+            p_report->heap_used  = (prj_i32_t)(before.free_size - after.free_size);
+            p_report->heap_freed = 0;
+            /* A new low mark means the peak was reached during this init, otherwise only the net use is known */
+            p_report->heap_peak  = (after.min_free_size < before.min_free_size) ? (before.free_size - after.min_free_size) :
+                                   ((p_report->heap_used > 0) ? (prj_u32_t)p_report->heap_used : 0U);
+
+            if (!skip && (p_report->status != PRJ_SUCCESS))
+            {
+                ESP_LOGE(PRJ_STARTUP_TAG, "startup task: %s failed, status 0x%" PRIx32, p_entry->p_name, p_report->status);
+            }
+
+            portENTER_CRITICAL(&m_run_lock);
+            m_run.done |= (1UL << index);
+            if (p_report->status != PRJ_SUCCESS)
+            {
+                m_run.failed |= (1UL << index);
+            }
+            portEXIT_CRITICAL(&m_run_lock);
+
+            xEventGroupSetBits(m_run.event_group, (EventBits_t)(1UL << index));
+        }
+        else if (wait != 0U)
+        {
+            /* Sleep until another entry is done, then look again */
+            xEventGroupWaitBits(m_run.event_group, (EventBits_t)wait, pdFALSE, pdFALSE, portMAX_DELAY);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    xTaskNotifyGive(m_run.owner);
+
+    /* Deleted by prj_startup_run() */
+    p_worker->stopped = true;
+    vTaskSuspend(NULL);
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -17,16 +17,183 @@
  * Definitions
  **************************************************************************************************/
 #define PRJ_TIME_SYNC_TAG "TIME_SYNC"
+
+#define PRJ_TIME_SYNC_ERROR_UNKNOWN   (INT64_MAX) /*!< Clock error is unbounded, e.g. after power loss */
+#define PRJ_TIME_SYNC_NTP_SERVER_MAX  (4U)        /*!< Maximum number of servers queried in parallel */
+#define PRJ_TIME_SYNC_CB_MAX          (4U)        /*!< Maximum number of registered callbacks */
 /***************************************************************************************************
  * Macros
  **************************************************************************************************/
 /***************************************************************************************************
  * Types
  **************************************************************************************************/
+typedef enum
+{
+    PRJ_TIME_SYNC_EVENT_SYNCED = 0, /*!< Clock corrected by a sync */
+    PRJ_TIME_SYNC_EVENT_FAILED,     /*!< Sync timed out or no server answered */
+} prj_time_sync_event_t;
+
+/**
+ * @brief Time sync result callback.
+ *
+ * Called from the task that ran the sync, so it must return quickly and never block.
+ */
+typedef void (*prj_time_sync_cb_t)(const prj_time_sync_event_t event, void *const p_ctx);
+
+typedef struct
+{
+    prj_i64_t rtt_us;    /*!< Round-trip time of the request the offset was taken from */
+    prj_i64_t offset_us; /*!< Offset applied to the system clock */
+    prj_bool_t slewed;   /*!< Offset is slewed in gradually rather than stepped */
+} prj_time_sync_result_t;
+
+typedef struct
+{
+    const prj_char_t *p_host; /*!< Server host name or address */
+    prj_u16_t port;           /*!< UDP port, 0 for the standard NTP port */
+} prj_time_sync_server_t;
+
+typedef struct
+{
+    prj_i64_t (*rtc_us)(void);                      /*!< Clock that keeps counting across resets and deep sleep */
+    prj_i64_t (*wall_us)(void);                     /*!< Read the wall clock, UTC microseconds */
+    void (*wall_set_us)(const prj_i64_t wall_us);   /*!< Step the wall clock, UTC microseconds */
+    void (*wall_slew_us)(const prj_i64_t delta_us); /*!< Slew the wall clock by the given delta, replaces a pending slew */
+} prj_time_sync_clock_t;
+
+typedef struct
+{
+    prj_i32_t drift_ppb;    /*!< Estimated local oscillator drift, positive when the clock runs slow, 0 until measured */
+    prj_i64_t error_us;     /*!< Estimated clock error now, PRJ_TIME_SYNC_ERROR_UNKNOWN if never synced */
+    prj_i64_t next_sync_us; /*!< Time until the next background sync, -1 if not running or waiting for the link */
+    prj_u32_t sync_count;   /*!< Successful background syncs */
+    prj_u32_t fail_count;   /*!< Failed background syncs */
+} prj_time_sync_status_t;
 /***************************************************************************************************
  * API
  **************************************************************************************************/
+/**
+ * @brief Register a callback for the result of every sync, direct or background.
+ *
+ * @param cb    Callback function.
+ * @param p_ctx User context passed back to the callback.
+ *
+ * @return PRJ_SUCCESS, PRJ_ERROR_NULL or PRJ_ERROR_RESOURCES.
+ */
+prj_status_t prj_time_sync_cb_register(const prj_time_sync_cb_t cb, void *const p_ctx);
+
+/**
+ * @brief Synchronize the system time once.
+ *
+ * With CONFIG_SNTP_MULTI_SERVER the parallel NTP engine is used, otherwise the lwIP SNTP client
+ * and its completion notification. Either way the call returns as soon as the time is set.
+ *
+ * @param timeout_ms Deadline for the sync in milliseconds.
+ * @param p_result   Optional output for the measured round-trip time and applied offset.
+ *
+ * @return PRJ_SUCCESS, PRJ_ERROR_TIMEOUT, PRJ_ERROR_BUSY or PRJ_ERROR_RESOURCES.
+ */
+prj_status_t prj_time_sync_wait(const prj_u32_t timeout_ms, prj_time_sync_result_t *const p_result);
+
+/**
+ * @brief Query several NTP servers in parallel and correct the clock with the best offset.
+ *
+ * Each server keeps a short window of samples. The lowest delay sample of every server is taken,
+ * servers disagreeing with the median are rejected and the closest survivor wins. Offsets up to
+ * CONFIG_SNTP_SLEW_THRESHOLD_MS are slewed, larger ones are stepped. The run ends as soon as
+ * CONFIG_SNTP_QUORUM servers answered.
+ *
+ * @param p_servers  Servers to query.
+ * @param count      Number of servers, up to PRJ_TIME_SYNC_NTP_SERVER_MAX.
+ * @param timeout_ms Deadline for the run in milliseconds.
+ * @param p_result   Output for the selected sample delay and the applied offset.
+ *
+ * Serialized with prj_time_sync_wait() and the background service like any other sync.
+ *
+ * @return PRJ_SUCCESS, PRJ_ERROR_NULL, PRJ_ERROR_INVALID_PARAM, PRJ_ERROR_TIMEOUT or PRJ_ERROR_BUSY.
+ */
+prj_status_t prj_time_sync_ntp_run(const prj_time_sync_server_t *const p_servers, const prj_u8_t count,
+                                   const prj_u32_t timeout_ms, prj_time_sync_result_t *const p_result);
+
+/**
+ * @brief Synchronize the system time once with the CONFIG_SNTP_TIME_SYNC_TOUT_MS deadline.
+ */
 prj_status_t prj_time_sync_once(void);
+
+/**
+ * @brief Restore the wall clock from the record saved at the last sync.
+ *
+ * Call early at startup. The record lives in RTC memory, so it survives deep sleep and soft resets.
+ *
+ * @return PRJ_SUCCESS if the clock was restored, PRJ_ERROR_NOT_FOUND otherwise.
+ */
+prj_status_t prj_time_sync_restore(void);
+
+/**
+ * @brief Estimated error of the wall clock, from the last sync error plus the drift since then.
+ *
+ * @return Error in microseconds or PRJ_TIME_SYNC_ERROR_UNKNOWN.
+ */
+prj_i64_t prj_time_sync_error_us(void);
+
+/**
+ * @brief Check whether the estimated error exceeds CONFIG_SNTP_MAX_ERROR_MS.
+ */
+prj_bool_t prj_time_sync_needed(void);
+
+/**
+ * @brief Start the background time maintenance service.
+ *
+ * The service resyncs whenever the estimated error is about to exceed CONFIG_SNTP_MAX_ERROR_MS.
+ * The interval follows the drift measured from successive syncs and stays within
+ * CONFIG_SNTP_BG_INTERVAL_MIN_S and CONFIG_SNTP_BG_INTERVAL_MAX_S. Without a valid persisted time the
+ * first sync waits for prj_time_sync_radio_awake(), so it does not run before the link is up.
+ *
+ * @return PRJ_SUCCESS, PRJ_ERROR_INVALID_STATE if already running or PRJ_ERROR_RESOURCES.
+ */
+prj_status_t prj_time_sync_background_start(void);
+
+/**
+ * @brief Stop the background service and release the kernel objects of the component.
+ *
+ * Fails without changing anything while a sync, direct or background, is in progress. The persisted
+ * record and the published time are kept, so prj_time_now_us() stays valid.
+ *
+ * @return PRJ_SUCCESS or PRJ_ERROR_BUSY if a sync is running right now, try again once it finished.
+ */
+prj_status_t prj_time_sync_deinit(void);
+
+/**
+ * @brief Tell the background service that the radio is awake for another reason.
+ *
+ * A sync more than half way through its interval is pulled in, so it shares the radio wake-up.
+ * Does not block, safe to call from event handlers.
+ */
+void prj_time_sync_radio_awake(void);
+
+/**
+ * @brief Get the current drift, error estimate and background schedule.
+ *
+ * @return PRJ_SUCCESS or PRJ_ERROR_NULL.
+ */
+prj_status_t prj_time_sync_status_get(prj_time_sync_status_t *const p_status);
+
+/**
+ * @brief Current UTC time in microseconds, from esp_timer plus the offset published by the last sync.
+ *
+ * Lock-free and safe from ISRs and both cores, costs one esp_timer read. Slewed corrections are
+ * applied at about 500 ppm, so the value never jumps for them, only for stepped ones.
+ *
+ * @return UTC microseconds, 0 until the clock was synced or restored.
+ */
+prj_i64_t prj_time_now_us(void);
+
+/**
+ * @brief Replace the clock source, e.g. with a stub on the Linux host target.
+ *
+ * @param p_clock Clock source, NULL restores the default one. Must stay valid while in use.
+ */
+void prj_time_sync_clock_set(const prj_time_sync_clock_t *const p_clock);
 #endif /* TIME_SYNC_H */
 /***************************************************************************************************
  * EOF
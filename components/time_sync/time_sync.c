@@ -12,70 +12,312 @@
  **************************************************************************************************/
 #include "lwip/ip_addr.h"
 #include "esp_sntp.h"
-#include "time_sync.h"
+#include "esp_timer.h"
+#include "time_sync_priv.h"
+#include "prj_prof.h"
+#include "prj_metrics.h"
 
 #include <sys/time.h>
 #include <time.h>
+#include <inttypes.h>
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "freertos/semphr.h"
 /***************************************************************************************************
  * Definitions
  **************************************************************************************************/
-#define PRJ_TIME_SYNC_RETRY_CONNECT_MAX (5U)
-#define PRJ_TIME_SYNC_YEAR_THRESHOLD    (2025)
-#define PRJ_TIME_SYNC_YEAR_OFFSET       (1900)
 /***************************************************************************************************
  * Macros
  **************************************************************************************************/
+#define PRJ_TIME_SYNC_I32_SAT(x) ((prj_i32_t)(((x) > INT32_MAX) ? INT32_MAX : (((x) < INT32_MIN) ? INT32_MIN : (x))))
 /***************************************************************************************************
  * Types
  **************************************************************************************************/
+typedef struct
+{
+    prj_time_sync_cb_t cb;
+    void *p_ctx;
+} time_sync_cb_entry_t;
 /***************************************************************************************************
  * Static functions declaration
  **************************************************************************************************/
+static prj_bool_t time_sync_busy_take(void);
+static void time_sync_busy_give(void);
+static void time_sync_notify(const prj_time_sync_event_t event);
+#if CONFIG_SNTP_MULTI_SERVER
+static prj_status_t time_sync_ntp_servers_run(const prj_u32_t timeout_ms, prj_time_sync_result_t *const p_result);
+#else
+static prj_status_t time_sync_sntp_run(const prj_u32_t timeout_ms, prj_time_sync_result_t *const p_result);
+static void time_sync_notification_cb(struct timeval *p_tv);
+#endif
 /***************************************************************************************************
  * Variables
  **************************************************************************************************/
+static portMUX_TYPE m_busy_lock = portMUX_INITIALIZER_UNLOCKED;
+static prj_bool_t m_busy = false;
+
+static time_sync_cb_entry_t m_cb_table[PRJ_TIME_SYNC_CB_MAX] = {0};
+static prj_u8_t m_cb_count = 0U;
+static portMUX_TYPE m_cb_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if CONFIG_SNTP_MULTI_SERVER
+static const prj_char_t *const m_server_names[] = {
+    CONFIG_SNTP_TIME_SERVER,
+    CONFIG_SNTP_TIME_SERVER_2,
+    CONFIG_SNTP_TIME_SERVER_3,
+};
+#else
+static StaticSemaphore_t m_sync_sem_buf;
+static SemaphoreHandle_t m_sync_sem = NULL;
+static prj_i64_t m_request_timer_us = 0;
+static prj_i64_t m_request_wall_us = 0;
+static prj_time_sync_result_t m_result = {0};
+#endif
 /***************************************************************************************************
  * API
  **************************************************************************************************/
-prj_status_t prj_time_sync_once(void)
+prj_status_t prj_time_sync_cb_register(const prj_time_sync_cb_t cb, void *const p_ctx)
+{
+    prj_status_t status = PRJ_SUCCESS;
+
+    if (cb == NULL)
+    {
+        return PRJ_ERROR_NULL;
+    }
+
+    portENTER_CRITICAL(&m_cb_lock);
+
+    if (m_cb_count < PRJ_TIME_SYNC_CB_MAX)
+    {
+        m_cb_table[m_cb_count].cb    = cb;
+        m_cb_table[m_cb_count].p_ctx = p_ctx;
+        m_cb_count++;
+    }
+    else
+    {
+        status = PRJ_ERROR_RESOURCES;
+    }
+
+    portEXIT_CRITICAL(&m_cb_lock);
+
+    return status;
+}
+
+prj_status_t prj_time_sync_wait(const prj_u32_t timeout_ms, prj_time_sync_result_t *const p_result)
 {
     prj_status_t status = PRJ_SUCCESS;
+    prj_time_sync_result_t result = {0};
     time_t time_now = 0;
     struct tm time_info = {0};
-    prj_u8_t retry_num = 0U;
 
-    esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
-    esp_sntp_setservername(0, CONFIG_SNTP_TIME_SERVER);
-    esp_sntp_init();
+    /* The background service and a direct caller may race for the network */
+    if (!time_sync_busy_take())
+    {
+        ESP_LOGW(PRJ_TIME_SYNC_TAG, "time sync wait: sync already in progress");
+        return PRJ_ERROR_BUSY;
+    }
+
+    ESP_LOGI(PRJ_TIME_SYNC_TAG, "time sync wait: waiting for system time to be set (%lu ms)", (unsigned long)timeout_ms);
+
+    prj_prof_begin(PRJ_PROF_PHASE_SNTP_REQ);
 
-    while((time_info.tm_year < (PRJ_TIME_SYNC_YEAR_THRESHOLD - PRJ_TIME_SYNC_YEAR_OFFSET)) && (++retry_num < PRJ_TIME_SYNC_RETRY_CONNECT_MAX)) 
+#if CONFIG_SNTP_MULTI_SERVER
+    status = time_sync_ntp_servers_run(timeout_ms, &result);
+#else
+    status = time_sync_sntp_run(timeout_ms, &result);
+#endif
+
+    if (status == PRJ_SUCCESS)
     {
-        ESP_LOGI(PRJ_TIME_SYNC_TAG, "time obtain: waiting for system time to be set... (%d/%d)", retry_num, PRJ_TIME_SYNC_RETRY_CONNECT_MAX);
-        vTaskDelay(2000 / portTICK_PERIOD_MS);
         time(&time_now);
         localtime_r(&time_now, &time_info);
-    }
+        ESP_LOGI(PRJ_TIME_SYNC_TAG, "time sync wait: time synchronized, rtt %" PRId64 " us, offset %" PRId64 " us%s: %s",
+                 result.rtt_us, result.offset_us, result.slewed ? " (slewing)" : "", asctime(&time_info));
 
-    if (time_info.tm_year >= (PRJ_TIME_SYNC_YEAR_THRESHOLD - PRJ_TIME_SYNC_YEAR_OFFSET)) 
-    {
-        ESP_LOGI(PRJ_TIME_SYNC_TAG, "time obtain: time synchronized: %s", asctime(&time_info));
-        status =  PRJ_SUCCESS;
+        time_sync_persist_update(&result);
+        prj_prof_end(PRJ_PROF_PHASE_SNTP_SET);
+
+        PRJ_METRICS_ADD(TIME_SYNC_SYNCS, 1U);
+        PRJ_METRICS_SET(TIME_SYNC_RTT_US, PRJ_TIME_SYNC_I32_SAT(result.rtt_us));
+        PRJ_METRICS_SET(TIME_SYNC_OFFSET_US, PRJ_TIME_SYNC_I32_SAT(result.offset_us));
+        PRJ_METRICS_SET(TIME_SYNC_DRIFT_PPB, time_sync_persist_drift_ppb());
+        PRJ_METRICS_MARK(TIME_SYNC_LAST);
+
+        if (p_result != NULL)
+        {
+            *p_result = result;
+        }
     }
     else
     {
-        ESP_LOGW(PRJ_TIME_SYNC_TAG, "time obtain: time not synchronized");
-        status =  PRJ_ERROR_TIMEOUT;
+        ESP_LOGW(PRJ_TIME_SYNC_TAG, "time sync wait: time not synchronized");
+        PRJ_METRICS_ADD(TIME_SYNC_FAILS, 1U);
     }
 
-    esp_sntp_stop();
+    time_sync_busy_give();
+
+    time_sync_notify((status == PRJ_SUCCESS) ? PRJ_TIME_SYNC_EVENT_SYNCED : PRJ_TIME_SYNC_EVENT_FAILED);
+
+    return status;
+}
+
+prj_status_t prj_time_sync_ntp_run(const prj_time_sync_server_t *const p_servers, const prj_u8_t count,
+                                   const prj_u32_t timeout_ms, prj_time_sync_result_t *const p_result)
+{
+    prj_status_t status = PRJ_SUCCESS;
+
+    /* The engine keeps the per server sample windows, one run at a time */
+    if (!time_sync_busy_take())
+    {
+        return PRJ_ERROR_BUSY;
+    }
+
+    status = time_sync_ntp_run(p_servers, count, timeout_ms, p_result);
+    time_sync_busy_give();
 
     return status;
 }
+
+prj_status_t prj_time_sync_once(void)
+{
+    return prj_time_sync_wait(CONFIG_SNTP_TIME_SYNC_TOUT_MS, NULL);
+}
+
+prj_status_t prj_time_sync_deinit(void)
+{
+    /* Hold the busy flag so no sync starts while the objects go away, a sync in progress leaves all in place */
+    if (!time_sync_busy_take())
+    {
+        ESP_LOGW(PRJ_TIME_SYNC_TAG, "time sync deinit: sync in progress");
+        return PRJ_ERROR_BUSY;
+    }
+
+    time_sync_background_stop();
+
+#if !CONFIG_SNTP_MULTI_SERVER
+    if (m_sync_sem != NULL)
+    {
+        vSemaphoreDelete(m_sync_sem);
+        m_sync_sem = NULL;
+    }
+#endif
+
+    time_sync_busy_give();
+
+    return PRJ_SUCCESS;
+}
 /***************************************************************************************************
  * STATIC
  **************************************************************************************************/
+static prj_bool_t time_sync_busy_take(void)
+{
+    prj_bool_t busy = false;
+
+    portENTER_CRITICAL(&m_busy_lock);
+    busy = m_busy;
+    m_busy = true;
+    portEXIT_CRITICAL(&m_busy_lock);
+
+    return !busy;
+}
+
+static void time_sync_busy_give(void)
+{
+    portENTER_CRITICAL(&m_busy_lock);
+    m_busy = false;
+    portEXIT_CRITICAL(&m_busy_lock);
+
+    return;
+}
+
+static void time_sync_notify(const prj_time_sync_event_t event)
+{
+    prj_u8_t count = 0U;
+
+    portENTER_CRITICAL(&m_cb_lock);
+    count = m_cb_count;
+    portEXIT_CRITICAL(&m_cb_lock);
+
+    for (prj_u8_t i = 0U; i < count; i++)
+    {
+        m_cb_table[i].cb(event, m_cb_table[i].p_ctx);
+    }
+
+    return;
+}
+
+#if CONFIG_SNTP_MULTI_SERVER
+static prj_status_t time_sync_ntp_servers_run(const prj_u32_t timeout_ms, prj_time_sync_result_t *const p_result)
+{
+    prj_time_sync_server_t servers[PRJ_TIME_SYNC_NTP_SERVER_MAX] = {0};
+    prj_u8_t count = 0U;
+
+    for (prj_size_t i = 0U; (i < (sizeof(m_server_names) / sizeof(m_server_names[0]))) && (count < PRJ_TIME_SYNC_NTP_SERVER_MAX); i++)
+    {
+        if (m_server_names[i][0] != '\0')
+        {
+            servers[count++].p_host = m_server_names[i];
+        }
+    }
+
+    return time_sync_ntp_run(servers, count, timeout_ms, p_result);
+}
+#else
+static prj_status_t time_sync_sntp_run(const prj_u32_t timeout_ms, prj_time_sync_result_t *const p_result)
+{
+    prj_status_t status = PRJ_SUCCESS;
+
+    if (m_sync_sem == NULL)
+    {
+        m_sync_sem = xSemaphoreCreateBinaryStatic(&m_sync_sem_buf);
+    }
+
+    /* Drop a stale notification left over from a previous timed out sync */
+    xSemaphoreTake(m_sync_sem, 0);
+
+    m_request_wall_us = time_sync_clock_wall_us();
+    m_request_timer_us = esp_timer_get_time();
+
+    esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    esp_sntp_setservername(0, CONFIG_SNTP_TIME_SERVER);
+    sntp_set_sync_mode(SNTP_SYNC_MODE_IMMED);
+    sntp_set_time_sync_notification_cb(time_sync_notification_cb);
+    esp_sntp_init();
+
+    if (xSemaphoreTake(m_sync_sem, pdMS_TO_TICKS(timeout_ms)) == pdTRUE)
+    {
+        prj_prof_end(PRJ_PROF_PHASE_SNTP_REQ);
+        prj_prof_begin(PRJ_PROF_PHASE_SNTP_SET);
+        /* lwIP stepped the system clock itself */
+        time_sync_clock_publish();
+        *p_result = m_result;
+        status = PRJ_SUCCESS;
+    }
+    else
+    {
+        status = PRJ_ERROR_TIMEOUT;
+    }
+
+    esp_sntp_stop();
+    sntp_set_time_sync_notification_cb(NULL);
+
+    return status;
+}
+
+static void time_sync_notification_cb(struct timeval *p_tv)
+{
+    prj_i64_t elapsed_us = esp_timer_get_time() - m_request_timer_us;
+    prj_i64_t synced_us = ((prj_i64_t)p_tv->tv_sec * PRJ_TIME_SYNC_US_PER_SEC) + p_tv->tv_usec;
+
+    m_result.rtt_us = elapsed_us;
+    /* Compare against the time the clock would show now without the correction */
+    m_result.offset_us = synced_us - (m_request_wall_us + elapsed_us);
+    m_result.slewed = false;
+
+    xSemaphoreGive(m_sync_sem);
+
+    return;
+}
+#endif
 /***************************************************************************************************
  * EOF
  **************************************************************************************************/
@@ -0,0 +1,264 @@
+/**
+ * @file time_sync_background.c
+ * @date 05/13/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "time_sync_priv.h"
+#include "prj_log.h"
+
+#include <stdint.h>
+#include <inttypes.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_TIME_SYNC_BG_TASK_NAME     "time_sync"
+#define PRJ_TIME_SYNC_BG_TASK_STACK    (4096U)
+#define PRJ_TIME_SYNC_BG_TASK_PRIO     (2U)
+#define PRJ_TIME_SYNC_BG_INTERVAL_MIN  ((prj_i64_t)CONFIG_SNTP_BG_INTERVAL_MIN_S * PRJ_TIME_SYNC_US_PER_SEC)
+#define PRJ_TIME_SYNC_BG_INTERVAL_MAX  ((prj_i64_t)CONFIG_SNTP_BG_INTERVAL_MAX_S * PRJ_TIME_SYNC_US_PER_SEC)
+#define PRJ_TIME_SYNC_BG_TARGET_US     ((prj_i64_t)CONFIG_SNTP_MAX_ERROR_MS * 1000LL)
+#define PRJ_TIME_SYNC_BG_FAIL_SHIFT    (10U)
+#define PRJ_TIME_SYNC_BG_STOP_POLL_MS  (10U)
+#define PRJ_TIME_SYNC_BG_ON_HINT       (INT64_MAX) /* Next sync: none planned, wait for the radio hint */
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void time_sync_bg_task(void *p_arg);
+static prj_i64_t time_sync_bg_interval_us(void);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static StaticTask_t m_bg_task_buf;
+static StackType_t m_bg_task_stack[PRJ_TIME_SYNC_BG_TASK_STACK];
+static TaskHandle_t m_bg_task = NULL;
+static volatile prj_bool_t m_bg_stop = false;
+static volatile prj_bool_t m_bg_stopped = false;
+static portMUX_TYPE m_bg_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile prj_u32_t m_bg_notifiers = 0U; /* Callers between taking the task handle and notifying it */
+static prj_i64_t m_last_sync_us = 0; /* esp_timer time of the last scheduling decision */
+static prj_i64_t m_next_sync_us = 0; /* esp_timer time of the next planned sync */
+static prj_u32_t m_sync_count = 0U;
+static prj_u32_t m_fail_count = 0U;
+static prj_u32_t m_fail_streak = 0U;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+prj_status_t prj_time_sync_background_start(void)
+{
+    if (m_bg_task != NULL)
+    {
+        return PRJ_ERROR_INVALID_STATE;
+    }
+
+    m_last_sync_us = esp_timer_get_time();
+
+    /* Never synced: the link is most likely not up yet, so the first sync waits until it is */
+    m_next_sync_us = (prj_time_sync_error_us() == PRJ_TIME_SYNC_ERROR_UNKNOWN) ? PRJ_TIME_SYNC_BG_ON_HINT :
+                     (m_last_sync_us + time_sync_bg_interval_us());
+    m_bg_stop = false;
+    m_bg_stopped = false;
+
+    m_bg_task = xTaskCreateStatic(time_sync_bg_task, PRJ_TIME_SYNC_BG_TASK_NAME, PRJ_TIME_SYNC_BG_TASK_STACK,
+                                  NULL, PRJ_TIME_SYNC_BG_TASK_PRIO, m_bg_task_stack, &m_bg_task_buf);
+
+    if (m_bg_task == NULL)
+    {
+        ESP_LOGE(PRJ_TIME_SYNC_TAG, "time sync background: failed to create task");
+        return PRJ_ERROR_RESOURCES;
+    }
+
+    return PRJ_SUCCESS;
+}
+
+void time_sync_background_stop(void)
+{
+    TaskHandle_t task = m_bg_task;
+
+    if (task == NULL)
+    {
+        return;
+    }
+
+    m_bg_stop = true;
+    xTaskNotifyGive(task);
+
+    /* A sync in progress finishes first. The static task memory is free again only once deleted */
+    while (!m_bg_stopped || (eTaskGetState(task) != eSuspended))
+    {
+        vTaskDelay(pdMS_TO_TICKS(PRJ_TIME_SYNC_BG_STOP_POLL_MS));
+    }
+
+    portENTER_CRITICAL(&m_bg_lock);
+    m_bg_task = NULL;
+    portEXIT_CRITICAL(&m_bg_lock);
+
+    /* A radio hint may still hold the handle it took before it was cleared */
+    while (m_bg_notifiers != 0U)
+    {
+        vTaskDelay(pdMS_TO_TICKS(PRJ_TIME_SYNC_BG_STOP_POLL_MS));
+    }
+
+    vTaskDelete(task);
+
+    return;
+}
+
+void prj_time_sync_radio_awake(void)
+{
+    TaskHandle_t task = NULL;
+
+    /* No FreeRTOS calls inside the spinlock, the notifier count keeps the task alive until notified */
+    portENTER_CRITICAL(&m_bg_lock);
+    task = m_bg_task;
+    m_bg_notifiers += (task != NULL) ? 1U : 0U;
+    portEXIT_CRITICAL(&m_bg_lock);
+
+    if (task == NULL)
+    {
+        return;
+    }
+
+    xTaskNotifyGive(task);
+
+    portENTER_CRITICAL(&m_bg_lock);
+    m_bg_notifiers--;
+    portEXIT_CRITICAL(&m_bg_lock);
+
+    return;
+}
+
+prj_status_t prj_time_sync_status_get(prj_time_sync_status_t *const p_status)
+{
+    if (p_status == NULL)
+    {
+        return PRJ_ERROR_NULL;
+    }
+
+    p_status->drift_ppb = time_sync_persist_drift_ppb();
+    p_status->error_us = prj_time_sync_error_us();
+
+    portENTER_CRITICAL(&m_bg_lock);
+    p_status->next_sync_us = ((m_bg_task != NULL) && (m_next_sync_us != PRJ_TIME_SYNC_BG_ON_HINT)) ?
+                             (m_next_sync_us - esp_timer_get_time()) : -1;
+    p_status->sync_count = m_sync_count;
+    p_status->fail_count = m_fail_count;
+    portEXIT_CRITICAL(&m_bg_lock);
+
+    return PRJ_SUCCESS;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void time_sync_bg_task(void *p_arg)
+{
+    prj_i64_t now_us = 0;
+    prj_i64_t wait_us = 0;
+    prj_i64_t interval_us = 0;
+    prj_bool_t hint = false;
+    prj_status_t status = PRJ_SUCCESS;
+
+    while (!m_bg_stop)
+    {
+        now_us = esp_timer_get_time();
+        wait_us = (m_next_sync_us > now_us) ? (m_next_sync_us - now_us) : 0;
+        hint = (ulTaskNotifyTake(pdTRUE, (m_next_sync_us == PRJ_TIME_SYNC_BG_ON_HINT) ? portMAX_DELAY :
+                                 pdMS_TO_TICKS(wait_us / 1000)) != 0U);
+        now_us = esp_timer_get_time();
+
+        if (m_bg_stop)
+        {
+            break;
+        }
+
+        /* The radio is up anyway: resync early if the clock is off or half the interval has passed */
+        if (hint && (m_next_sync_us != PRJ_TIME_SYNC_BG_ON_HINT) && !prj_time_sync_needed() &&
+            (now_us < (m_last_sync_us + ((m_next_sync_us - m_last_sync_us) / 2))))
+        {
+            continue;
+        }
+
+        if (!hint && (now_us < m_next_sync_us))
+        {
+            continue;
+        }
+
+        status = prj_time_sync_once();
+        now_us = esp_timer_get_time();
+
+        if (status == PRJ_SUCCESS)
+        {
+            m_fail_streak = 0U;
+            interval_us = time_sync_bg_interval_us();
+        }
+        else if (status == PRJ_ERROR_BUSY)
+        {
+            /* Someone else is syncing right now, re-evaluate afterwards */
+            interval_us = PRJ_TIME_SYNC_BG_INTERVAL_MIN;
+        }
+        else
+        {
+            m_fail_streak = (m_fail_streak < PRJ_TIME_SYNC_BG_FAIL_SHIFT) ? (m_fail_streak + 1U) : m_fail_streak;
+            interval_us = PRJ_TIME_SYNC_BG_INTERVAL_MIN << (m_fail_streak - 1U);
+            interval_us = (interval_us < PRJ_TIME_SYNC_BG_INTERVAL_MAX) ? interval_us : PRJ_TIME_SYNC_BG_INTERVAL_MAX;
+        }
+
+        portENTER_CRITICAL(&m_bg_lock);
+        m_sync_count += (status == PRJ_SUCCESS) ? 1U : 0U;
+        m_fail_count += ((status != PRJ_SUCCESS) && (status != PRJ_ERROR_BUSY)) ? 1U : 0U;
+        m_last_sync_us = now_us;
+        m_next_sync_us = now_us + interval_us;
+        portEXIT_CRITICAL(&m_bg_lock);
+
+        PRJ_LOG(TIME_SYNC_SCHEDULE, (prj_u32_t)time_sync_persist_drift_ppb(), (prj_u32_t)(interval_us / PRJ_TIME_SYNC_US_PER_SEC));
+    }
+
+    /* Deleted by time_sync_background_stop(), which waits for the suspension */
+    m_bg_stopped = true;
+    vTaskSuspend(NULL);
+}
+
+static prj_i64_t time_sync_bg_interval_us(void)
+{
+    prj_i64_t error_us = prj_time_sync_error_us();
+    prj_i64_t drift_ppb = time_sync_persist_drift_bound_ppb();
+    prj_i64_t interval_us = 0;
+
+    if (error_us == PRJ_TIME_SYNC_ERROR_UNKNOWN)
+    {
+        return 0;
+    }
+
+    /* Time until the drift eats up what is left of the error budget */
+    drift_ppb = (drift_ppb > 0) ? drift_ppb : 1;
+    interval_us = ((PRJ_TIME_SYNC_BG_TARGET_US - error_us) * PRJ_TIME_SYNC_PPB) / drift_ppb;
+
+    if (interval_us < PRJ_TIME_SYNC_BG_INTERVAL_MIN)
+    {
+        interval_us = PRJ_TIME_SYNC_BG_INTERVAL_MIN;
+    }
+    else if (interval_us > PRJ_TIME_SYNC_BG_INTERVAL_MAX)
+    {
+        interval_us = PRJ_TIME_SYNC_BG_INTERVAL_MAX;
+    }
+
+    return interval_us;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,232 @@
+/**
+ * @file time_sync_clock.c
+ * @date 05/13/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "time_sync_priv.h"
+
+#include <sys/time.h>
+#include <time.h>
+#include <stdatomic.h>
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_rtc_time.h"
+#endif
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_TIME_SYNC_NOW_SLEW_SHIFT (11U) /* Slew rate of prj_time_now_us(), 1/2048 or about 488 ppm */
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+/* Readers retry while seq is odd or changed under them, so every field is read as one snapshot */
+typedef struct
+{
+    _Atomic prj_u32_t seq;
+    volatile prj_i64_t offset_us;     /*!< Wall clock minus esp_timer, 0 until the clock is set */
+    volatile prj_i64_t slew_start_us; /*!< esp_timer time the pending slew started */
+    volatile prj_i64_t slew_us;       /*!< Correction still to be slewed in */
+} time_sync_now_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static prj_i64_t time_sync_clock_default_rtc_us(void);
+static prj_i64_t time_sync_clock_default_wall_us(void);
+static void time_sync_clock_default_wall_set_us(const prj_i64_t wall_us);
+static void time_sync_clock_default_wall_slew_us(const prj_i64_t delta_us);
+static IRAM_ATTR prj_i64_t time_sync_now_slewed_us(const prj_i64_t now_us, const prj_i64_t slew_start_us, const prj_i64_t slew_us);
+static void time_sync_now_publish(const prj_i64_t offset_us, const prj_i64_t slew_us);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static const prj_time_sync_clock_t m_clock_default = {
+    .rtc_us       = time_sync_clock_default_rtc_us,
+    .wall_us      = time_sync_clock_default_wall_us,
+    .wall_set_us  = time_sync_clock_default_wall_set_us,
+    .wall_slew_us = time_sync_clock_default_wall_slew_us,
+};
+
+static const prj_time_sync_clock_t *m_p_clock = &m_clock_default;
+
+static portMUX_TYPE m_now_lock = portMUX_INITIALIZER_UNLOCKED;
+static DRAM_ATTR time_sync_now_t m_now = {0};
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void prj_time_sync_clock_set(const prj_time_sync_clock_t *const p_clock)
+{
+    m_p_clock = (p_clock != NULL) ? p_clock : &m_clock_default;
+
+    return;
+}
+
+IRAM_ATTR prj_i64_t prj_time_now_us(void)
+{
+    prj_u32_t seq = 0U;
+    prj_i64_t now_us = 0;
+    prj_i64_t offset_us = 0;
+    prj_i64_t slew_start_us = 0;
+    prj_i64_t slew_us = 0;
+
+    do
+    {
+        seq = atomic_load_explicit(&m_now.seq, memory_order_acquire);
+        offset_us = m_now.offset_us;
+        slew_start_us = m_now.slew_start_us;
+        slew_us = m_now.slew_us;
+        atomic_thread_fence(memory_order_acquire);
+    } while ((seq & 1U) || (seq != atomic_load_explicit(&m_now.seq, memory_order_relaxed)));
+
+    if (offset_us == 0)
+    {
+        return 0;
+    }
+
+    now_us = esp_timer_get_time();
+
+    return now_us + offset_us + time_sync_now_slewed_us(now_us, slew_start_us, slew_us);
+}
+
+prj_i64_t time_sync_clock_rtc_us(void)
+{
+    return m_p_clock->rtc_us();
+}
+
+prj_i64_t time_sync_clock_wall_us(void)
+{
+    return m_p_clock->wall_us();
+}
+
+void time_sync_clock_wall_set_us(const prj_i64_t wall_us)
+{
+    m_p_clock->wall_set_us(wall_us);
+    time_sync_clock_publish();
+
+    return;
+}
+
+void time_sync_clock_wall_slew_us(const prj_i64_t delta_us)
+{
+    m_p_clock->wall_slew_us(delta_us);
+    time_sync_now_publish(0, delta_us);
+
+    return;
+}
+
+void time_sync_clock_publish(void)
+{
+    time_sync_now_publish(m_p_clock->wall_us() - esp_timer_get_time(), 0);
+
+    return;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static IRAM_ATTR prj_i64_t time_sync_now_slewed_us(const prj_i64_t now_us, const prj_i64_t slew_start_us, const prj_i64_t slew_us)
+{
+    /* A shift instead of a division keeps the ISR path free of libgcc calls */
+    prj_i64_t step_us = (now_us - slew_start_us) >> PRJ_TIME_SYNC_NOW_SLEW_SHIFT;
+
+    if (slew_us >= 0)
+    {
+        return (step_us < slew_us) ? step_us : slew_us;
+    }
+
+    return (step_us < -slew_us) ? -step_us : slew_us;
+}
+
+static void time_sync_now_publish(const prj_i64_t offset_us, const prj_i64_t slew_us)
+{
+    prj_i64_t now_us = esp_timer_get_time();
+    prj_i64_t applied_us = 0;
+    prj_u32_t seq = 0U;
+
+    /* The critical section keeps readers on this core from spinning on a half written update */
+    portENTER_CRITICAL(&m_now_lock);
+    seq = atomic_load_explicit(&m_now.seq, memory_order_relaxed);
+    atomic_store_explicit(&m_now.seq, seq + 1U, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    if (offset_us != 0)
+    {
+        /* Step: take the new offset, drop any slew in progress */
+        m_now.offset_us = offset_us;
+        m_now.slew_us = 0;
+    }
+    else if (m_now.offset_us != 0)
+    {
+        /* Slew: fold in what was already applied, the new correction replaces the rest as adjtime() does.
+         * It was measured against a clock that already includes the partial slew */
+        applied_us = time_sync_now_slewed_us(now_us, m_now.slew_start_us, m_now.slew_us);
+        m_now.offset_us += applied_us;
+        m_now.slew_us = slew_us;
+    }
+
+    m_now.slew_start_us = now_us;
+
+    atomic_store_explicit(&m_now.seq, seq + 2U, memory_order_release);
+    portEXIT_CRITICAL(&m_now_lock);
+
+    return;
+}
+
+static prj_i64_t time_sync_clock_default_rtc_us(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec ts = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((prj_i64_t)ts.tv_sec * PRJ_TIME_SYNC_US_PER_SEC) + (ts.tv_nsec / 1000);
+#else
+    return (prj_i64_t)esp_rtc_get_time_us();
+#endif
+}
+
+static prj_i64_t time_sync_clock_default_wall_us(void)
+{
+    struct timeval tv = {0};
+
+    gettimeofday(&tv, NULL);
+
+    return ((prj_i64_t)tv.tv_sec * PRJ_TIME_SYNC_US_PER_SEC) + tv.tv_usec;
+}
+
+static void time_sync_clock_default_wall_set_us(const prj_i64_t wall_us)
+{
+    struct timeval tv = {
+        .tv_sec  = (time_t)(wall_us / PRJ_TIME_SYNC_US_PER_SEC),
+        .tv_usec = (suseconds_t)(wall_us % PRJ_TIME_SYNC_US_PER_SEC),
+    };
+
+    settimeofday(&tv, NULL);
+
+    return;
+}
+
+static void time_sync_clock_default_wall_slew_us(const prj_i64_t delta_us)
+{
+    struct timeval tv = {
+        .tv_sec  = (time_t)(delta_us / PRJ_TIME_SYNC_US_PER_SEC),
+        .tv_usec = (suseconds_t)(delta_us % PRJ_TIME_SYNC_US_PER_SEC),
+    };
+
+    adjtime(&tv, NULL);
+
+    return;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
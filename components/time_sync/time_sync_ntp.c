@@ -0,0 +1,572 @@
+/**
+ * @file time_sync_ntp.c
+ * @date 05/13/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "time_sync_priv.h"
+#include "prj_prof.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "esp_timer.h"
+#include "lwip/dns.h"
+#include "lwip/tcpip.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_TIME_SYNC_NTP_PORT          (123U)
+#define PRJ_TIME_SYNC_NTP_PACKET_SIZE   (48U)
+#define PRJ_TIME_SYNC_NTP_UNIX_OFFSET   (2208988800LL) /* Seconds from 1900 to 1970 */
+#define PRJ_TIME_SYNC_NTP_MODE_CLIENT   (0x23U)        /* LI 0, VN 4, mode 3 */
+#define PRJ_TIME_SYNC_NTP_MODE_SERVER   (4U)
+#define PRJ_TIME_SYNC_NTP_LI_ALARM      (3U)
+#define PRJ_TIME_SYNC_NTP_STRATUM_MAX   (15U)
+#define PRJ_TIME_SYNC_NTP_OFF_ORIGIN    (24U)
+#define PRJ_TIME_SYNC_NTP_OFF_RECEIVE   (32U)
+#define PRJ_TIME_SYNC_NTP_OFF_TRANSMIT  (40U)
+
+#define PRJ_TIME_SYNC_NTP_WINDOW        (8U)   /* Clock filter depth per server, as in RFC 5905 */
+#define PRJ_TIME_SYNC_NTP_BURST         (4U)   /* Requests per server and run */
+#define PRJ_TIME_SYNC_NTP_REQ_TOUT_US   (1000000LL)
+#define PRJ_TIME_SYNC_NTP_SAMPLE_AGE_US (600LL * PRJ_TIME_SYNC_US_PER_SEC)
+#define PRJ_TIME_SYNC_NTP_OUTLIER_US    (10000LL)
+#define PRJ_TIME_SYNC_NTP_PHI_PPB       ((prj_i64_t)CONFIG_SNTP_RTC_DRIFT_PPM * 1000LL) /* Dispersion growth of an aging sample */
+#define PRJ_TIME_SYNC_NTP_SLEW_MAX_US   ((prj_i64_t)CONFIG_SNTP_SLEW_THRESHOLD_MS * 1000LL)
+#define PRJ_TIME_SYNC_NTP_HOST_LEN      (64U)
+#define PRJ_TIME_SYNC_NTP_DNS_POLL_US   (20000LL) /* Select slice while a lookup is still open */
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef enum
+{
+    PRJ_TIME_SYNC_NTP_DNS_PENDING = 0,
+    PRJ_TIME_SYNC_NTP_DNS_DONE,
+    PRJ_TIME_SYNC_NTP_DNS_FAILED,
+} time_sync_ntp_dns_state_t;
+
+typedef struct
+{
+    prj_char_t host[PRJ_TIME_SYNC_NTP_HOST_LEN];
+    prj_u32_t addr;                  /*!< IPv4 address in network order once done */
+    prj_u32_t run;                   /*!< Run the lookup belongs to, answers for an earlier run are dropped */
+    time_sync_ntp_dns_state_t state;
+} time_sync_ntp_dns_t;
+
+typedef struct
+{
+    prj_i64_t offset_us;
+    prj_i64_t delay_us;
+    prj_i64_t taken_us; /*!< esp_timer time the sample was taken */
+} time_sync_ntp_sample_t;
+
+typedef struct
+{
+    prj_char_t host[PRJ_TIME_SYNC_NTP_HOST_LEN]; /*!< Copied, the caller's string may be gone by the next run */
+    time_sync_ntp_sample_t samples[PRJ_TIME_SYNC_NTP_WINDOW];
+    prj_u8_t head;
+    prj_u8_t count;
+} time_sync_ntp_window_t;
+
+typedef struct
+{
+    int fd;
+    prj_u8_t origin[8];  /*!< Transmit timestamp of the outstanding request */
+    prj_i64_t sent_us;   /*!< esp_timer time of the outstanding request */
+    prj_u8_t replies;
+    prj_bool_t done;
+} time_sync_ntp_peer_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void time_sync_ntp_resolve(const prj_time_sync_server_t *const p_servers, const prj_u8_t count);
+static void time_sync_ntp_dns_start(void *p_arg);
+static void time_sync_ntp_dns_found(const char *p_name, const ip_addr_t *p_addr, void *p_arg);
+static int time_sync_ntp_open(const prj_u32_t addr, const prj_u16_t port);
+static void time_sync_ntp_send(time_sync_ntp_peer_t *const p_peer, const prj_i64_t local_us, const prj_i64_t now_us);
+static prj_bool_t time_sync_ntp_parse(const prj_u8_t *const p_packet, const prj_size_t len, const time_sync_ntp_peer_t *const p_peer,
+                                      const prj_i64_t t1_us, const prj_i64_t t4_us, time_sync_ntp_sample_t *const p_sample);
+static prj_bool_t time_sync_ntp_select(const prj_u8_t count, const prj_i64_t now_us, time_sync_ntp_sample_t *const p_best);
+static prj_i64_t time_sync_ntp_distance(const time_sync_ntp_sample_t *const p_sample, const prj_i64_t now_us);
+static void time_sync_ntp_window_add(time_sync_ntp_window_t *const p_window, const time_sync_ntp_sample_t *const p_sample);
+static void time_sync_ntp_ts_write(prj_u8_t *const p_dst, const prj_i64_t unix_us);
+static prj_i64_t time_sync_ntp_ts_read(const prj_u8_t *const p_src);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static time_sync_ntp_window_t m_windows[PRJ_TIME_SYNC_NTP_SERVER_MAX] = {0};
+
+/* Written from the lwIP thread, an abandoned lookup may still answer after its run returned */
+static time_sync_ntp_dns_t m_dns[PRJ_TIME_SYNC_NTP_SERVER_MAX] = {0};
+static prj_u32_t m_dns_run = 0U;
+static portMUX_TYPE m_dns_lock = portMUX_INITIALIZER_UNLOCKED;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+prj_status_t time_sync_ntp_run(const prj_time_sync_server_t *const p_servers, const prj_u8_t count,
+                               const prj_u32_t timeout_ms, prj_time_sync_result_t *const p_result)
+{
+    time_sync_ntp_peer_t peers[PRJ_TIME_SYNC_NTP_SERVER_MAX] = {0};
+    time_sync_ntp_sample_t sample = {0};
+    prj_u8_t packet[PRJ_TIME_SYNC_NTP_PACKET_SIZE] = {0};
+    struct timeval tv = {0};
+    fd_set fds;
+    int fd_max = -1;
+    time_sync_ntp_dns_t dns = {0};
+    prj_u8_t failed = 0U;
+    prj_u8_t done = 0U;
+    prj_u8_t quorum = 0U;
+    prj_i64_t start_us = 0;
+    prj_i64_t wall_base_us = 0;
+    prj_i64_t deadline_us = 0;
+    prj_i64_t now_us = 0;
+    prj_i64_t wait_us = 0;
+    prj_bool_t resolving = false;
+    ssize_t len = 0;
+
+    if ((p_servers == NULL) || (p_result == NULL))
+    {
+        return PRJ_ERROR_NULL;
+    }
+
+    if ((count == 0U) || (count > PRJ_TIME_SYNC_NTP_SERVER_MAX))
+    {
+        return PRJ_ERROR_INVALID_PARAM;
+    }
+
+    /* Local timestamps come from esp_timer anchored to the wall clock, so a slew in progress does not skew them */
+    start_us = esp_timer_get_time();
+    wall_base_us = time_sync_clock_wall_us() - start_us;
+    deadline_us = start_us + ((prj_i64_t)timeout_ms * 1000LL);
+
+    for (prj_u8_t i = 0U; i < count; i++)
+    {
+        if (strncmp(m_windows[i].host, p_servers[i].p_host, sizeof(m_windows[i].host)) != 0)
+        {
+            memset(&m_windows[i], 0, sizeof(m_windows[i]));
+            strncpy(m_windows[i].host, p_servers[i].p_host, sizeof(m_windows[i].host) - 1U);
+        }
+
+        peers[i].fd = -1;
+    }
+
+    /* Lookups run alongside the requests, each server is asked as soon as its address is known */
+    time_sync_ntp_resolve(p_servers, count);
+
+    /* Only the first good answers are needed, a slow server must not hold the sync back */
+    quorum = (count < CONFIG_SNTP_QUORUM) ? count : CONFIG_SNTP_QUORUM;
+
+    while ((done < quorum) && ((now_us = esp_timer_get_time()) < deadline_us))
+    {
+        FD_ZERO(&fds);
+        fd_max = -1;
+        resolving = false;
+
+        for (prj_u8_t i = 0U; i < count; i++)
+        {
+            if (peers[i].done)
+            {
+                continue;
+            }
+
+            if (peers[i].fd < 0)
+            {
+                portENTER_CRITICAL(&m_dns_lock);
+                dns = m_dns[i];
+                portEXIT_CRITICAL(&m_dns_lock);
+
+                if (dns.state == PRJ_TIME_SYNC_NTP_DNS_PENDING)
+                {
+                    resolving = true;
+                    continue;
+                }
+
+                if (dns.state == PRJ_TIME_SYNC_NTP_DNS_DONE)
+                {
+                    peers[i].fd = time_sync_ntp_open(dns.addr, (p_servers[i].port != 0U) ? p_servers[i].port : PRJ_TIME_SYNC_NTP_PORT);
+                }
+
+                if (peers[i].fd < 0)
+                {
+                    ESP_LOGW(PRJ_TIME_SYNC_TAG, "time sync ntp: failed to reach %s", p_servers[i].p_host);
+                    peers[i].done = true;
+                    failed++;
+                    continue;
+                }
+
+                time_sync_ntp_send(&peers[i], wall_base_us + now_us, now_us);
+            }
+
+            /* Lost request, ask again */
+            if ((now_us - peers[i].sent_us) >= PRJ_TIME_SYNC_NTP_REQ_TOUT_US)
+            {
+                time_sync_ntp_send(&peers[i], wall_base_us + now_us, now_us);
+            }
+
+            FD_SET(peers[i].fd, &fds);
+            fd_max = (peers[i].fd > fd_max) ? peers[i].fd : fd_max;
+        }
+
+        /* Fewer servers left than the quorum, the run ends once all of them answered */
+        quorum = ((count - failed) < quorum) ? (count - failed) : quorum;
+
+        wait_us = deadline_us - now_us;
+        wait_us = (wait_us < PRJ_TIME_SYNC_NTP_REQ_TOUT_US) ? wait_us : PRJ_TIME_SYNC_NTP_REQ_TOUT_US;
+        wait_us = (resolving && (wait_us > PRJ_TIME_SYNC_NTP_DNS_POLL_US)) ? PRJ_TIME_SYNC_NTP_DNS_POLL_US : wait_us;
+        tv.tv_sec = (time_t)(wait_us / PRJ_TIME_SYNC_US_PER_SEC);
+        tv.tv_usec = (suseconds_t)(wait_us % PRJ_TIME_SYNC_US_PER_SEC);
+
+        /* Nothing to listen on while every open server still resolves, sleep instead of spinning */
+        if (fd_max < 0)
+        {
+            vTaskDelay((pdMS_TO_TICKS(wait_us / 1000) != 0U) ? pdMS_TO_TICKS(wait_us / 1000) : 1U);
+            continue;
+        }
+
+        if (select(fd_max + 1, &fds, NULL, NULL, &tv) <= 0)
+        {
+            continue;
+        }
+
+        for (prj_u8_t i = 0U; i < count; i++)
+        {
+            if (peers[i].done || !FD_ISSET(peers[i].fd, &fds))
+            {
+                continue;
+            }
+
+            len = recv(peers[i].fd, packet, sizeof(packet), 0);
+            now_us = esp_timer_get_time();
+
+            if ((len < 0) ||
+                !time_sync_ntp_parse(packet, (prj_size_t)len, &peers[i], wall_base_us + peers[i].sent_us, wall_base_us + now_us, &sample))
+            {
+                continue;
+            }
+
+            sample.taken_us = now_us;
+            time_sync_ntp_window_add(&m_windows[i], &sample);
+
+            if (++peers[i].replies < PRJ_TIME_SYNC_NTP_BURST)
+            {
+                time_sync_ntp_send(&peers[i], wall_base_us + now_us, now_us);
+            }
+            else
+            {
+                peers[i].done = true;
+                done++;
+            }
+        }
+    }
+
+    /* Servers still unresolved at the deadline are skipped, their late answers are ignored */
+    for (prj_u8_t i = 0U; i < count; i++)
+    {
+        if (peers[i].fd >= 0)
+        {
+            close(peers[i].fd);
+        }
+    }
+
+    if (!time_sync_ntp_select(count, esp_timer_get_time(), &sample))
+    {
+        return PRJ_ERROR_TIMEOUT;
+    }
+
+    prj_prof_end(PRJ_PROF_PHASE_SNTP_REQ);
+    prj_prof_begin(PRJ_PROF_PHASE_SNTP_SET);
+
+    p_result->rtt_us = sample.delay_us;
+    p_result->offset_us = sample.offset_us;
+    p_result->slewed = (llabs((long long)sample.offset_us) <= PRJ_TIME_SYNC_NTP_SLEW_MAX_US);
+
+    /* Slew small corrections so timestamps never jump, step only the large ones */
+    if (p_result->slewed)
+    {
+        time_sync_clock_wall_slew_us(sample.offset_us);
+    }
+    else
+    {
+        time_sync_clock_wall_set_us(time_sync_clock_wall_us() + sample.offset_us);
+    }
+
+    /* Samples still in the windows were measured against the uncorrected clock */
+    for (prj_u8_t i = 0U; i < count; i++)
+    {
+        for (prj_u8_t j = 0U; j < m_windows[i].count; j++)
+        {
+            m_windows[i].samples[j].offset_us -= sample.offset_us;
+        }
+    }
+
+    return PRJ_SUCCESS;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void time_sync_ntp_resolve(const prj_time_sync_server_t *const p_servers, const prj_u8_t count)
+{
+    prj_u32_t run = 0U;
+
+    portENTER_CRITICAL(&m_dns_lock);
+    run = ++m_dns_run;
+
+    for (prj_u8_t i = 0U; i < count; i++)
+    {
+        m_dns[i].run = run;
+        m_dns[i].state = (strlen(p_servers[i].p_host) < sizeof(m_dns[i].host)) ? PRJ_TIME_SYNC_NTP_DNS_PENDING : PRJ_TIME_SYNC_NTP_DNS_FAILED;
+        strncpy(m_dns[i].host, p_servers[i].p_host, sizeof(m_dns[i].host) - 1U);
+        m_dns[i].host[sizeof(m_dns[i].host) - 1U] = '\0';
+    }
+    portEXIT_CRITICAL(&m_dns_lock);
+
+    /* lwIP DNS may only be called from its own thread, the tag carries the run and the server index */
+    for (prj_u8_t i = 0U; i < count; i++)
+    {
+        if ((m_dns[i].state == PRJ_TIME_SYNC_NTP_DNS_PENDING) &&
+            (tcpip_callback(time_sync_ntp_dns_start, (void *)(uintptr_t)((run * PRJ_TIME_SYNC_NTP_SERVER_MAX) + i)) != ERR_OK))
+        {
+            portENTER_CRITICAL(&m_dns_lock);
+            m_dns[i].state = PRJ_TIME_SYNC_NTP_DNS_FAILED;
+            portEXIT_CRITICAL(&m_dns_lock);
+        }
+    }
+
+    return;
+}
+
+static void time_sync_ntp_dns_start(void *p_arg)
+{
+    const prj_u32_t index = (prj_u32_t)(uintptr_t)p_arg % PRJ_TIME_SYNC_NTP_SERVER_MAX;
+    prj_char_t host[PRJ_TIME_SYNC_NTP_HOST_LEN] = {0};
+    ip_addr_t addr = {0};
+    err_t err = ERR_OK;
+
+    portENTER_CRITICAL(&m_dns_lock);
+    memcpy(host, m_dns[index].host, sizeof(host));
+    portEXIT_CRITICAL(&m_dns_lock);
+
+    /* Cached names and address literals answer at once, the rest through the callback */
+    err = dns_gethostbyname_addrtype(host, &addr, time_sync_ntp_dns_found, p_arg, LWIP_DNS_ADDRTYPE_IPV4);
+
+    if (err != ERR_INPROGRESS)
+    {
+        time_sync_ntp_dns_found(host, (err == ERR_OK) ? &addr : NULL, p_arg);
+    }
+
+    return;
+}
+
+static void time_sync_ntp_dns_found(const char *p_name, const ip_addr_t *p_addr, void *p_arg)
+{
+    const prj_u32_t tag = (prj_u32_t)(uintptr_t)p_arg;
+    time_sync_ntp_dns_t *p_dns = &m_dns[tag % PRJ_TIME_SYNC_NTP_SERVER_MAX];
+
+    portENTER_CRITICAL(&m_dns_lock);
+    if (p_dns->run == (tag / PRJ_TIME_SYNC_NTP_SERVER_MAX))
+    {
+        p_dns->state = (p_addr != NULL) ? PRJ_TIME_SYNC_NTP_DNS_DONE : PRJ_TIME_SYNC_NTP_DNS_FAILED;
+        p_dns->addr = (p_addr != NULL) ? ip4_addr_get_u32(ip_2_ip4(p_addr)) : 0U;
+    }
+    portEXIT_CRITICAL(&m_dns_lock);
+
+    return;
+}
+
+static int time_sync_ntp_open(const prj_u32_t addr, const prj_u16_t port)
+{
+    struct sockaddr_in server = {
+        .sin_family      = AF_INET,
+        .sin_port        = htons(port),
+        .sin_addr.s_addr = addr,
+    };
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    /* Connected UDP socket only delivers replies from this server */
+    if ((fd >= 0) && (connect(fd, (const struct sockaddr *)&server, sizeof(server)) != 0))
+    {
+        close(fd);
+        fd = -1;
+    }
+
+    return fd;
+}
+
+static void time_sync_ntp_send(time_sync_ntp_peer_t *const p_peer, const prj_i64_t local_us, const prj_i64_t now_us)
+{
+    prj_u8_t packet[PRJ_TIME_SYNC_NTP_PACKET_SIZE] = {0};
+
+    packet[0] = PRJ_TIME_SYNC_NTP_MODE_CLIENT;
+    time_sync_ntp_ts_write(&packet[PRJ_TIME_SYNC_NTP_OFF_TRANSMIT], local_us);
+
+    memcpy(p_peer->origin, &packet[PRJ_TIME_SYNC_NTP_OFF_TRANSMIT], sizeof(p_peer->origin));
+    p_peer->sent_us = now_us;
+
+    send(p_peer->fd, packet, sizeof(packet), 0);
+
+    return;
+}
+
+static prj_bool_t time_sync_ntp_parse(const prj_u8_t *const p_packet, const prj_size_t len, const time_sync_ntp_peer_t *const p_peer,
+                                      const prj_i64_t t1_us, const prj_i64_t t4_us, time_sync_ntp_sample_t *const p_sample)
+{
+    prj_i64_t t2_us = 0;
+    prj_i64_t t3_us = 0;
+
+    if ((len < PRJ_TIME_SYNC_NTP_PACKET_SIZE) ||
+        ((p_packet[0] & 0x07U) != PRJ_TIME_SYNC_NTP_MODE_SERVER) ||
+        ((p_packet[0] >> 6) == PRJ_TIME_SYNC_NTP_LI_ALARM) ||
+        (p_packet[1] == 0U) || (p_packet[1] > PRJ_TIME_SYNC_NTP_STRATUM_MAX) ||
+        (memcmp(&p_packet[PRJ_TIME_SYNC_NTP_OFF_ORIGIN], p_peer->origin, sizeof(p_peer->origin)) != 0))
+    {
+        return false;
+    }
+
+    t2_us = time_sync_ntp_ts_read(&p_packet[PRJ_TIME_SYNC_NTP_OFF_RECEIVE]);
+    t3_us = time_sync_ntp_ts_read(&p_packet[PRJ_TIME_SYNC_NTP_OFF_TRANSMIT]);
+
+    p_sample->offset_us = ((t2_us - t1_us) + (t3_us - t4_us)) / 2;
+    p_sample->delay_us = (t4_us - t1_us) - (t3_us - t2_us);
+    p_sample->delay_us = (p_sample->delay_us > 0) ? p_sample->delay_us : 0;
+
+    return true;
+}
+
+static prj_bool_t time_sync_ntp_select(const prj_u8_t count, const prj_i64_t now_us, time_sync_ntp_sample_t *const p_best)
+{
+    time_sync_ntp_sample_t candidates[PRJ_TIME_SYNC_NTP_SERVER_MAX] = {0};
+    time_sync_ntp_sample_t tmp = {0};
+    const time_sync_ntp_sample_t *p_median = NULL;
+    prj_u8_t found = 0U;
+    prj_i64_t spread_us = 0;
+    prj_bool_t have_best = false;
+
+    /* Clock filter: per server, the sample with the lowest distance is the most trustworthy. An older sample was
+     * rebased after the last correction, but the clock drifted since, so its age counts against it */
+    for (prj_u8_t i = 0U; i < count; i++)
+    {
+        const time_sync_ntp_sample_t *p_pick = NULL;
+
+        for (prj_u8_t j = 0U; j < m_windows[i].count; j++)
+        {
+            const time_sync_ntp_sample_t *p_sample = &m_windows[i].samples[j];
+
+            if (((now_us - p_sample->taken_us) <= PRJ_TIME_SYNC_NTP_SAMPLE_AGE_US) &&
+                ((p_pick == NULL) || (time_sync_ntp_distance(p_sample, now_us) < time_sync_ntp_distance(p_pick, now_us))))
+            {
+                p_pick = p_sample;
+            }
+        }
+
+        if (p_pick != NULL)
+        {
+            candidates[found++] = *p_pick;
+        }
+    }
+
+    if (found == 0U)
+    {
+        return false;
+    }
+
+    /* Sort by offset to find the median */
+    for (prj_u8_t i = 1U; i < found; i++)
+    {
+        for (prj_u8_t j = i; (j > 0U) && (candidates[j - 1U].offset_us > candidates[j].offset_us); j--)
+        {
+            tmp = candidates[j];
+            candidates[j] = candidates[j - 1U];
+            candidates[j - 1U] = tmp;
+        }
+    }
+
+    p_median = &candidates[found / 2U];
+
+    /* Reject servers whose correctness interval does not overlap the median one, pick the closest survivor */
+    for (prj_u8_t i = 0U; i < found; i++)
+    {
+        spread_us = ((candidates[i].delay_us + p_median->delay_us) / 2) + PRJ_TIME_SYNC_NTP_OUTLIER_US;
+
+        if (llabs((long long)(candidates[i].offset_us - p_median->offset_us)) > spread_us)
+        {
+            ESP_LOGW(PRJ_TIME_SYNC_TAG, "time sync ntp: outlier rejected, offset %" PRId64 " us", candidates[i].offset_us);
+            continue;
+        }
+
+        if (!have_best || (time_sync_ntp_distance(&candidates[i], now_us) < time_sync_ntp_distance(p_best, now_us)))
+        {
+            *p_best = candidates[i];
+            have_best = true;
+        }
+    }
+
+    return have_best;
+}
+
+static prj_i64_t time_sync_ntp_distance(const time_sync_ntp_sample_t *const p_sample, const prj_i64_t now_us)
+{
+    /* Root distance as in RFC 5905: half the round trip plus the dispersion grown since the sample was taken */
+    return (p_sample->delay_us / 2) + (((now_us - p_sample->taken_us) * PRJ_TIME_SYNC_NTP_PHI_PPB) / PRJ_TIME_SYNC_PPB);
+}
+
+static void time_sync_ntp_window_add(time_sync_ntp_window_t *const p_window, const time_sync_ntp_sample_t *const p_sample)
+{
+    p_window->samples[p_window->head] = *p_sample;
+    p_window->head = (p_window->head + 1U) % PRJ_TIME_SYNC_NTP_WINDOW;
+
+    if (p_window->count < PRJ_TIME_SYNC_NTP_WINDOW)
+    {
+        p_window->count++;
+    }
+
+    return;
+}
+
+static void time_sync_ntp_ts_write(prj_u8_t *const p_dst, const prj_i64_t unix_us)
+{
+    prj_u32_t sec = (prj_u32_t)((unix_us / PRJ_TIME_SYNC_US_PER_SEC) + PRJ_TIME_SYNC_NTP_UNIX_OFFSET);
+    prj_u32_t frac = (prj_u32_t)((((prj_u64_t)(unix_us % PRJ_TIME_SYNC_US_PER_SEC)) << 32) / PRJ_TIME_SYNC_US_PER_SEC);
+
+    for (prj_u8_t i = 0U; i < 4U; i++)
+    {
+        p_dst[i] = (prj_u8_t)(sec >> (24U - (8U * i)));
+        p_dst[4U + i] = (prj_u8_t)(frac >> (24U - (8U * i)));
+    }
+
+    return;
+}
+
+static prj_i64_t time_sync_ntp_ts_read(const prj_u8_t *const p_src)
+{
+    prj_u32_t sec = 0U;
+    prj_u32_t frac = 0U;
+
+    for (prj_u8_t i = 0U; i < 4U; i++)
+    {
+        sec = (sec << 8) | p_src[i];
+        frac = (frac << 8) | p_src[4U + i];
+    }
+
+    return (((prj_i64_t)sec - PRJ_TIME_SYNC_NTP_UNIX_OFFSET) * PRJ_TIME_SYNC_US_PER_SEC) +
+           (prj_i64_t)(((prj_u64_t)frac * PRJ_TIME_SYNC_US_PER_SEC) >> 32);
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,284 @@
+/**
+ * @file time_sync_persist.c
+ * @date 05/13/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "time_sync_priv.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "esp_attr.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_TIME_SYNC_PERSIST_MAGIC     (0x54535932U) /* "TSY2" */
+#define PRJ_TIME_SYNC_NVS_NAMESPACE     "time_sync"
+#define PRJ_TIME_SYNC_NVS_KEY           "persist"
+#define PRJ_TIME_SYNC_DRIFT_DEFAULT_PPB ((prj_i64_t)CONFIG_SNTP_RTC_DRIFT_PPM * 1000)
+#define PRJ_TIME_SYNC_DRIFT_SPAN_MIN_US (60LL * PRJ_TIME_SYNC_US_PER_SEC)
+#define PRJ_TIME_SYNC_DRIFT_NVS_DELTA   (1000)        /* Rewrite NVS when drift moves by 1 ppm */
+#define PRJ_TIME_SYNC_MAX_ERROR_US      ((prj_i64_t)CONFIG_SNTP_MAX_ERROR_MS * 1000LL)
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    prj_u32_t magic;
+    prj_i32_t drift_ppb;     /*!< Estimated local oscillator drift, positive when the clock runs slow */
+    prj_i64_t sync_wall_us;  /*!< Wall clock right after the last sync */
+    prj_i64_t sync_rtc_us;   /*!< RTC timer right after the last sync */
+    prj_i64_t sync_error_us; /*!< Error of the last sync itself */
+    prj_u32_t drift_samples; /*!< Measurements behind drift_ppb, none yet means it is unknown */
+    prj_u32_t checksum;
+} time_sync_persist_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void time_sync_persist_load(void);
+static void time_sync_persist_store(const prj_bool_t nvs);
+static prj_u32_t time_sync_persist_checksum(const time_sync_persist_t *const p_record);
+static prj_bool_t time_sync_persist_nvs_open(const nvs_open_mode_t mode, nvs_handle_t *const p_handle);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static RTC_NOINIT_ATTR time_sync_persist_t m_rtc_record;
+
+static time_sync_persist_t m_record = {0};
+static prj_bool_t m_loaded = false;
+static prj_bool_t m_record_valid = false;
+static prj_i32_t m_nvs_drift_ppb = 0;
+static prj_bool_t m_nvs_valid = false;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+prj_status_t prj_time_sync_restore(void)
+{
+    prj_i64_t elapsed_us = 0;
+
+    time_sync_persist_load();
+
+    if (!m_record_valid)
+    {
+        ESP_LOGI(PRJ_TIME_SYNC_TAG, "time sync restore: no valid record, sync required");
+        return PRJ_ERROR_NOT_FOUND;
+    }
+
+    elapsed_us = time_sync_clock_rtc_us() - m_record.sync_rtc_us;
+    time_sync_clock_wall_set_us(m_record.sync_wall_us + elapsed_us);
+
+    ESP_LOGI(PRJ_TIME_SYNC_TAG, "time sync restore: clock restored, %" PRId64 " s since sync, error %" PRId64 " us",
+             (prj_i64_t)(elapsed_us / PRJ_TIME_SYNC_US_PER_SEC), prj_time_sync_error_us());
+
+    return PRJ_SUCCESS;
+}
+
+prj_i64_t prj_time_sync_error_us(void)
+{
+    prj_i64_t elapsed_us = 0;
+
+    time_sync_persist_load();
+
+    if (!m_record_valid)
+    {
+        return PRJ_TIME_SYNC_ERROR_UNKNOWN;
+    }
+
+    elapsed_us = time_sync_clock_rtc_us() - m_record.sync_rtc_us;
+
+    return m_record.sync_error_us + ((elapsed_us / 1000) * time_sync_persist_drift_bound_ppb()) / (PRJ_TIME_SYNC_PPB / 1000);
+}
+
+prj_bool_t prj_time_sync_needed(void)
+{
+    return prj_time_sync_error_us() > PRJ_TIME_SYNC_MAX_ERROR_US;
+}
+
+void time_sync_persist_update(const prj_time_sync_result_t *const p_result)
+{
+    prj_i64_t rtc_now_us = 0;
+    prj_i64_t span_us = 0;
+    prj_i64_t measured_ppb = 0;
+    prj_bool_t nvs = false;
+
+    time_sync_persist_load();
+
+    rtc_now_us = time_sync_clock_rtc_us();
+    span_us = rtc_now_us - m_record.sync_rtc_us;
+
+    /* The offset found by this sync is what the clock drifted since the previous one */
+    if (m_record_valid && (span_us >= PRJ_TIME_SYNC_DRIFT_SPAN_MIN_US))
+    {
+        measured_ppb = (p_result->offset_us * (PRJ_TIME_SYNC_PPB / 1000)) / (span_us / 1000);
+
+        /* The first measurement replaces the unknown, averaging it with a guess could cancel it out */
+        if (m_record.drift_samples == 0U)
+        {
+            m_record.drift_ppb = (prj_i32_t)measured_ppb;
+            nvs = true;
+        }
+        else
+        {
+            m_record.drift_ppb = (prj_i32_t)((m_record.drift_ppb + measured_ppb) / 2);
+        }
+
+        m_record.drift_samples += (m_record.drift_samples < UINT32_MAX) ? 1U : 0U;
+    }
+
+    /* A slewed correction is still being applied, record the time the clock converges to */
+    m_record.sync_wall_us = time_sync_clock_wall_us() + (p_result->slewed ? p_result->offset_us : 0);
+    m_record.sync_rtc_us = rtc_now_us;
+    m_record.sync_error_us = p_result->rtt_us / 2;
+    m_record_valid = true;
+
+    nvs = nvs || !m_nvs_valid || (abs(m_record.drift_ppb - m_nvs_drift_ppb) > PRJ_TIME_SYNC_DRIFT_NVS_DELTA);
+    time_sync_persist_store(nvs);
+
+    return;
+}
+
+prj_i32_t time_sync_persist_drift_ppb(void)
+{
+    time_sync_persist_load();
+
+    return m_record.drift_ppb;
+}
+
+prj_i64_t time_sync_persist_drift_bound_ppb(void)
+{
+    time_sync_persist_load();
+
+    /* Until measured only the magnitude the oscillator is specified for is known, not the sign */
+    return (m_record.drift_samples != 0U) ? llabs((long long)m_record.drift_ppb) : PRJ_TIME_SYNC_DRIFT_DEFAULT_PPB;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void time_sync_persist_load(void)
+{
+    nvs_handle_t handle = 0;
+    time_sync_persist_t nvs_record = {0};
+    prj_size_t size = sizeof(nvs_record);
+
+    if (m_loaded)
+    {
+        return;
+    }
+
+    m_loaded = true;
+    m_record.magic = PRJ_TIME_SYNC_PERSIST_MAGIC;
+
+    /* RTC memory survives deep sleep and soft resets, the RTC timer keeps counting across both */
+    if ((m_rtc_record.magic == PRJ_TIME_SYNC_PERSIST_MAGIC) &&
+        (m_rtc_record.checksum == time_sync_persist_checksum(&m_rtc_record)) &&
+        (m_rtc_record.sync_rtc_us <= time_sync_clock_rtc_us()))
+    {
+        m_record = m_rtc_record;
+        m_record_valid = true;
+    }
+
+    /* NVS survives power loss, but the RTC timer does not, so only the drift estimate is reused */
+    if (time_sync_persist_nvs_open(NVS_READONLY, &handle))
+    {
+        if ((nvs_get_blob(handle, PRJ_TIME_SYNC_NVS_KEY, &nvs_record, &size) == ESP_OK) &&
+            (size == sizeof(nvs_record)) &&
+            (nvs_record.magic == PRJ_TIME_SYNC_PERSIST_MAGIC) &&
+            (nvs_record.checksum == time_sync_persist_checksum(&nvs_record)))
+        {
+            m_nvs_valid = true;
+            m_nvs_drift_ppb = nvs_record.drift_ppb;
+
+            if (!m_record_valid)
+            {
+                m_record.drift_ppb = nvs_record.drift_ppb;
+                m_record.drift_samples = nvs_record.drift_samples;
+            }
+        }
+
+        nvs_close(handle);
+    }
+
+    return;
+}
+
+static void time_sync_persist_store(const prj_bool_t nvs)
+{
+    nvs_handle_t handle = 0;
+    esp_err_t err = ESP_OK;
+
+    m_record.checksum = time_sync_persist_checksum(&m_record);
+    m_rtc_record = m_record;
+
+    if (!nvs || !time_sync_persist_nvs_open(NVS_READWRITE, &handle))
+    {
+        return;
+    }
+
+    err = nvs_set_blob(handle, PRJ_TIME_SYNC_NVS_KEY, &m_record, sizeof(m_record));
+
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(handle);
+    }
+
+    if (err == ESP_OK)
+    {
+        m_nvs_valid = true;
+        m_nvs_drift_ppb = m_record.drift_ppb;
+    }
+    else
+    {
+        ESP_LOGW(PRJ_TIME_SYNC_TAG, "time sync persist: nvs write failed: %s", esp_err_to_name(err));
+    }
+
+    nvs_close(handle);
+
+    return;
+}
+
+static prj_u32_t time_sync_persist_checksum(const time_sync_persist_t *const p_record)
+{
+    const prj_u8_t *p_data = (const prj_u8_t *)p_record;
+    prj_u32_t hash = 2166136261U;
+
+    /* FNV-1a over everything but the checksum itself */
+    for (prj_size_t i = 0U; i < offsetof(time_sync_persist_t, checksum); i++)
+    {
+        hash = (hash ^ p_data[i]) * 16777619U;
+    }
+
+    return hash;
+}
+
+static prj_bool_t time_sync_persist_nvs_open(const nvs_open_mode_t mode, nvs_handle_t *const p_handle)
+{
+    esp_err_t err = nvs_flash_init();
+
+    if (err == ESP_OK)
+    {
+        err = nvs_open(PRJ_TIME_SYNC_NVS_NAMESPACE, mode, p_handle);
+    }
+
+    if ((err != ESP_OK) && (err != ESP_ERR_NVS_NOT_FOUND))
+    {
+        ESP_LOGW(PRJ_TIME_SYNC_TAG, "time sync persist: nvs unavailable: %s", esp_err_to_name(err));
+    }
+
+    return (err == ESP_OK);
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
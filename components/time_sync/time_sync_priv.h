@@ -0,0 +1,51 @@
+/**
+ * @file time_sync_priv.h
+ * @date 05/13/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef TIME_SYNC_PRIV_H
+#define TIME_SYNC_PRIV_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "time_sync.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_TIME_SYNC_US_PER_SEC (1000000LL)
+#define PRJ_TIME_SYNC_PPB        (1000000000LL)
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/* Clock layer, time_sync_clock.c */
+prj_i64_t time_sync_clock_rtc_us(void);
+prj_i64_t time_sync_clock_wall_us(void);
+void time_sync_clock_wall_set_us(const prj_i64_t wall_us);
+void time_sync_clock_wall_slew_us(const prj_i64_t delta_us);
+void time_sync_clock_publish(void);
+
+/* Background service, time_sync_background.c */
+void time_sync_background_stop(void);
+
+/* NTP engine, time_sync_ntp.c. The caller holds the busy flag */
+prj_status_t time_sync_ntp_run(const prj_time_sync_server_t *const p_servers, const prj_u8_t count,
+                               const prj_u32_t timeout_ms, prj_time_sync_result_t *const p_result);
+
+/* Persistence, time_sync_persist.c */
+void time_sync_persist_update(const prj_time_sync_result_t *const p_result);
+prj_i32_t time_sync_persist_drift_ppb(void);
+prj_i64_t time_sync_persist_drift_bound_ppb(void);
+#endif /* TIME_SYNC_PRIV_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
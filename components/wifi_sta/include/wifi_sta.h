@@ -13,20 +13,111 @@
  * Includes
  *************************************************************************************************/
 #include "prj_common.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
 /***************************************************************************************************
  * Definitions
  **************************************************************************************************/
 #define PRJ_WIFI_STA_TAG "WIFI_STA"
+
+#define PRJ_WIFI_STA_BIT_CONNECTED (BIT0) /*!< Associated with the AP */
+#define PRJ_WIFI_STA_BIT_FAIL      (BIT1) /*!< Retry budget exhausted, cleared on the next got IP */
+#define PRJ_WIFI_STA_BIT_GOT_IP    (BIT2) /*!< IP address obtained */
+#define PRJ_WIFI_STA_BIT_LOST_IP   (BIT3) /*!< IP address lost */
+
+#define PRJ_WIFI_STA_CB_MAX        (4U)   /*!< Maximum number of registered callbacks */
 /***************************************************************************************************
  * Macros
  **************************************************************************************************/
 /***************************************************************************************************
  * Types
  **************************************************************************************************/
+typedef enum
+{
+    PRJ_WIFI_STA_EVENT_CONNECTED = 0, /*!< Associated with the AP */
+    PRJ_WIFI_STA_EVENT_FAILED,        /*!< Retry budget exhausted, recovery continues in the background */
+    PRJ_WIFI_STA_EVENT_GOT_IP,        /*!< IP address obtained */
+    PRJ_WIFI_STA_EVENT_LOST_IP,       /*!< IP address lost */
+    PRJ_WIFI_STA_EVENT_LINK_UP,       /*!< Connectivity established or restored */
+    PRJ_WIFI_STA_EVENT_LINK_DOWN,     /*!< Connectivity lost, reconnecting with backoff */
+} prj_wifi_sta_event_t;
+
+/**
+ * @brief Wi-Fi station state callback.
+ *
+ * Called from the default event loop task, so it must return quickly and never block.
+ */
+typedef void (*prj_wifi_sta_cb_t)(const prj_wifi_sta_event_t event, void *const p_ctx);
+
+typedef struct
+{
+    prj_u32_t ap_hit;     /*!< Targeted connects to the cached AP that associated */
+    prj_u32_t ap_miss;    /*!< Targeted connects that failed and fell back to a full scan */
+    prj_u32_t lease_hit;  /*!< Connects that got the cached IP lease back */
+    prj_u32_t lease_miss; /*!< Connects that got a different or first lease */
+} prj_wifi_sta_cache_stats_t;
 /***************************************************************************************************
  * API
  **************************************************************************************************/
-void prj_wifi_sta_init (void);
+/**
+ * @brief Register a callback for Wi-Fi station state changes.
+ *
+ * @param cb    Callback function.
+ * @param p_ctx User context passed back to the callback.
+ *
+ * @return PRJ_SUCCESS, PRJ_ERROR_NULL or PRJ_ERROR_RESOURCES.
+ */
+prj_status_t prj_wifi_sta_cb_register (const prj_wifi_sta_cb_t cb, void *const p_ctx);
+
+/**
+ * @brief Start the Wi-Fi station without waiting for the connection.
+ *
+ * If the last good AP is cached in NVS, a targeted single-channel connect to it is tried first.
+ * With CONFIG_WIFI_STA_ROAM the station also moves to a stronger AP of the SSID once the signal degrades.
+ * NVS, esp_netif and the default event loop must be initialized before.
+ *
+ * @param p_event_group Optional output for the event group carrying PRJ_WIFI_STA_BIT_* bits.
+ *
+ * @return PRJ_SUCCESS, PRJ_ERROR_INVALID_STATE if already started or PRJ_ERROR_RESOURCES if a driver
+ *         call failed, with whatever was created up to then released again.
+ */
+prj_status_t prj_wifi_sta_start (EventGroupHandle_t *const p_event_group);
+
+/**
+ * @brief Stop the Wi-Fi station and release everything prj_wifi_sta_start() created.
+ *
+ * Unregisters the event handlers, deletes the reconnect timer, deinitializes the driver and destroys
+ * the netif. Registered callbacks are kept. Call from a task, not from a station callback.
+ *
+ * @return PRJ_SUCCESS or PRJ_ERROR_INVALID_STATE if not started.
+ */
+prj_status_t prj_wifi_sta_deinit (void);
+
+/**
+ * @brief Wait for any of the given PRJ_WIFI_STA_BIT_* bits.
+ *
+ * @param bits       Bits to wait for.
+ * @param timeout_ms Timeout in milliseconds.
+ *
+ * @return Event bits at the moment the wait finished, 0 if the station is not started.
+ */
+EventBits_t prj_wifi_sta_wait (const EventBits_t bits, const prj_u32_t timeout_ms);
+
+/**
+ * @brief Get the fast reconnect cache counters, kept across deep sleep.
+ *
+ * @return PRJ_SUCCESS or PRJ_ERROR_NULL.
+ */
+prj_status_t prj_wifi_sta_cache_stats_get (prj_wifi_sta_cache_stats_t *const p_stats);
+
+/**
+ * @brief Start the Wi-Fi station and block until connected, failed or timed out.
+ *
+ * Same preconditions as prj_wifi_sta_start().
+ *
+ * @return PRJ_SUCCESS once started, the prj_wifi_sta_start() error otherwise.
+ */
+prj_status_t prj_wifi_sta_init (void);
 #endif /* WIFI_STA_H */
 /***************************************************************************************************
  * EOF
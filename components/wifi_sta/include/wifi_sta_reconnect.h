@@ -0,0 +1,95 @@
+/**
+ * @file wifi_sta_reconnect.h
+ * @date 05/16/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef WIFI_STA_RECONNECT_H
+#define WIFI_STA_RECONNECT_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "prj_common.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_WIFI_STA_RC_ACTION_CONNECT      (0x01U) /*!< Call esp_wifi_connect() now */
+#define PRJ_WIFI_STA_RC_ACTION_ARM_TIMER    (0x02U) /*!< Arm the backoff timer with delay_us */
+#define PRJ_WIFI_STA_RC_ACTION_CANCEL_TIMER (0x04U) /*!< Stop the backoff timer */
+#define PRJ_WIFI_STA_RC_ACTION_FAILED       (0x08U) /*!< Retry budget exhausted, report failure once */
+#define PRJ_WIFI_STA_RC_ACTION_LINK_UP      (0x10U) /*!< Connectivity restored */
+#define PRJ_WIFI_STA_RC_ACTION_LINK_DOWN    (0x20U) /*!< Connectivity lost */
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef enum
+{
+    PRJ_WIFI_STA_RC_STATE_IDLE = 0,   /*!< Not started */
+    PRJ_WIFI_STA_RC_STATE_CONNECTING, /*!< Connect requested, waiting for association */
+    PRJ_WIFI_STA_RC_STATE_ASSOCIATED, /*!< Associated, waiting for an IP address */
+    PRJ_WIFI_STA_RC_STATE_ONLINE,     /*!< Associated with an IP address */
+    PRJ_WIFI_STA_RC_STATE_BACKOFF,    /*!< Waiting for the backoff timer before the next attempt */
+} prj_wifi_sta_rc_state_t;
+
+typedef enum
+{
+    PRJ_WIFI_STA_RC_INPUT_START = 0,
+    PRJ_WIFI_STA_RC_INPUT_STOP,
+    PRJ_WIFI_STA_RC_INPUT_CONNECTED,
+    PRJ_WIFI_STA_RC_INPUT_DISCONNECTED,
+    PRJ_WIFI_STA_RC_INPUT_GOT_IP,
+    PRJ_WIFI_STA_RC_INPUT_LOST_IP,
+    PRJ_WIFI_STA_RC_INPUT_TIMER,
+    PRJ_WIFI_STA_RC_INPUT_ROAM,     /*!< The next disconnect is a deliberate move to another AP */
+} prj_wifi_sta_rc_input_t;
+
+typedef struct
+{
+    prj_u32_t actions;  /*!< PRJ_WIFI_STA_RC_ACTION_* flags */
+    prj_u32_t delay_us; /*!< Backoff delay for PRJ_WIFI_STA_RC_ACTION_ARM_TIMER */
+} prj_wifi_sta_rc_output_t;
+
+typedef struct
+{
+    prj_u32_t base_us;           /*!< First backoff delay */
+    prj_u32_t max_us;            /*!< Backoff delay cap */
+    prj_u32_t fail_after;        /*!< Consecutive failures before PRJ_WIFI_STA_RC_ACTION_FAILED */
+    prj_u32_t (*p_random)(void); /*!< Random source for the jitter */
+} prj_wifi_sta_rc_config_t;
+
+typedef struct
+{
+    prj_wifi_sta_rc_config_t config;
+    prj_wifi_sta_rc_state_t state;
+    prj_u32_t failures; /*!< Consecutive failed attempts */
+    prj_u32_t attempts; /*!< Total connect attempts */
+    prj_bool_t link_up;
+    prj_bool_t fail_reported;
+    prj_bool_t roaming; /*!< Reconnect at once on the next disconnect */
+} prj_wifi_sta_rc_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/**
+ * @brief Initialize the reconnect state machine.
+ */
+void prj_wifi_sta_rc_init (prj_wifi_sta_rc_t *const p_rc, const prj_wifi_sta_rc_config_t *const p_config);
+
+/**
+ * @brief Feed an input into the reconnect state machine.
+ *
+ * Pure function of the state and the input, so the retry schedule can be replayed on the host.
+ *
+ * @return Actions the caller has to carry out.
+ */
+prj_wifi_sta_rc_output_t prj_wifi_sta_rc_step (prj_wifi_sta_rc_t *const p_rc, const prj_wifi_sta_rc_input_t input);
+#endif /* WIFI_STA_RECONNECT_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
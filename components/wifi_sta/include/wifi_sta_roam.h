@@ -0,0 +1,125 @@
+/**
+ * @file wifi_sta_roam.h
+ * @date 06/06/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef WIFI_STA_ROAM_H
+#define WIFI_STA_ROAM_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "prj_common.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_WIFI_STA_ROAM_ACTION_SCAN       (0x01U) /*!< Start a background scan for the SSID */
+#define PRJ_WIFI_STA_ROAM_ACTION_PIN        (0x02U) /*!< Pin the next connect to target */
+#define PRJ_WIFI_STA_ROAM_ACTION_DISCONNECT (0x04U) /*!< Leave the current AP, the reconnect goes to the pinned one */
+#define PRJ_WIFI_STA_ROAM_ACTION_UNPIN      (0x08U) /*!< Drop the pin, let the driver pick again */
+#define PRJ_WIFI_STA_ROAM_ACTION_MISS       (0x10U) /*!< Set with UNPIN when the pinned AP did not answer */
+
+#define PRJ_WIFI_STA_ROAM_CACHE_MAX         (8U)    /*!< Scan results kept, weakest dropped first */
+#define PRJ_WIFI_STA_ROAM_BSSID_LEN         (6U)
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef enum
+{
+    PRJ_WIFI_STA_ROAM_JOIN_NONE = 0, /*!< No roam in progress */
+    PRJ_WIFI_STA_ROAM_JOIN_LEAVING,  /*!< Waiting for the disconnect from the current AP */
+    PRJ_WIFI_STA_ROAM_JOIN_PINNED,   /*!< Waiting for the association with the pinned AP */
+} prj_wifi_sta_roam_join_t;
+
+typedef enum
+{
+    PRJ_WIFI_STA_ROAM_INPUT_CONNECT = 0, /*!< A connect attempt is about to start */
+    PRJ_WIFI_STA_ROAM_INPUT_CONNECTED,   /*!< Associated with p_bssid */
+    PRJ_WIFI_STA_ROAM_INPUT_DISCONNECTED,
+    PRJ_WIFI_STA_ROAM_INPUT_RSSI,        /*!< Signal sample of the current AP */
+    PRJ_WIFI_STA_ROAM_INPUT_SCAN_DONE,   /*!< Scan results for the SSID, possibly none */
+} prj_wifi_sta_roam_input_type_t;
+
+typedef struct
+{
+    prj_u8_t bssid[PRJ_WIFI_STA_ROAM_BSSID_LEN];
+    prj_u8_t channel;
+    prj_i8_t rssi;
+} prj_wifi_sta_roam_ap_t;
+
+typedef struct
+{
+    prj_wifi_sta_roam_input_type_t type;
+    prj_i64_t now_us;
+    prj_i8_t rssi;                       /*!< PRJ_WIFI_STA_ROAM_INPUT_RSSI */
+    const prj_u8_t *p_bssid;             /*!< PRJ_WIFI_STA_ROAM_INPUT_CONNECTED */
+    const prj_wifi_sta_roam_ap_t *p_aps; /*!< PRJ_WIFI_STA_ROAM_INPUT_SCAN_DONE */
+    prj_size_t count;
+} prj_wifi_sta_roam_input_t;
+
+typedef struct
+{
+    prj_u32_t actions;             /*!< PRJ_WIFI_STA_ROAM_ACTION_* flags */
+    prj_wifi_sta_roam_ap_t target; /*!< AP for PRJ_WIFI_STA_ROAM_ACTION_PIN */
+} prj_wifi_sta_roam_output_t;
+
+typedef struct
+{
+    prj_i8_t scan_rssi;      /*!< Background scans run while the smoothed RSSI is below this */
+    prj_u8_t hysteresis_db;  /*!< A candidate must beat the current AP by this much */
+    prj_u32_t scan_min_us;   /*!< Scan period once the signal is weak */
+    prj_u32_t scan_max_us;   /*!< Scan period cap, doubled after every scan without a better AP */
+    prj_u32_t cache_ttl_us;  /*!< Older scan results are not used */
+    prj_u32_t ban_us;        /*!< A pinned AP that did not answer is skipped this long */
+} prj_wifi_sta_roam_config_t;
+
+typedef struct
+{
+    prj_wifi_sta_roam_ap_t ap;
+    prj_i64_t seen_us;   /*!< Last scan that reported it */
+    prj_i64_t banned_us; /*!< Skipped until then */
+} prj_wifi_sta_roam_entry_t;
+
+typedef struct
+{
+    prj_wifi_sta_roam_config_t config;
+    prj_wifi_sta_roam_entry_t cache[PRJ_WIFI_STA_ROAM_CACHE_MAX];
+    prj_size_t count;
+    prj_u8_t bssid[PRJ_WIFI_STA_ROAM_BSSID_LEN]; /*!< Current AP */
+    prj_wifi_sta_roam_ap_t target;               /*!< Pinned AP while join is not NONE */
+    prj_wifi_sta_roam_join_t join;
+    prj_bool_t pinned;                           /*!< Driver config still carries the last PIN */
+    prj_bool_t associated;
+    prj_i32_t rssi_q4;                           /*!< Smoothed RSSI in 1/16 dB, valid once sampled */
+    prj_bool_t rssi_valid;
+    prj_i64_t scan_due_us;                       /*!< No background scan before then */
+    prj_u32_t scan_period_us;                    /*!< Wait after a scan that found nothing better */
+} prj_wifi_sta_roam_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/**
+ * @brief Initialize the roaming decision logic with an empty scan cache.
+ */
+void prj_wifi_sta_roam_init (prj_wifi_sta_roam_t *const p_roam, const prj_wifi_sta_roam_config_t *const p_config);
+
+/**
+ * @brief Feed an input into the roaming decision logic.
+ *
+ * Pure function of the state and the input, so the decisions can be replayed on the host against
+ * scripted scan results. The caller owns the driver: it scans, pins the BSSID and disconnects as told.
+ *
+ * @return Actions the caller has to carry out.
+ */
+prj_wifi_sta_roam_output_t prj_wifi_sta_roam_step (prj_wifi_sta_roam_t *const p_roam,
+                                                   const prj_wifi_sta_roam_input_t *const p_input);
+#endif /* WIFI_STA_ROAM_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
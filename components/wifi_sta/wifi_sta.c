@@ -10,21 +10,34 @@
 /***************************************************************************************************
  * Includes
  **************************************************************************************************/
-#include "wifi_sta.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/event_groups.h"
-#include "esp_wifi.h"
-#include "time_sync.h"
+#include "wifi_sta_priv.h"
+#include "wifi_sta_reconnect.h"
+#include "wifi_sta_roam.h"
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "prj_prof.h"
+#include "prj_log.h"
+#include "prj_metrics.h"
+
+#include <string.h>
 /***************************************************************************************************
  * Definitions
  **************************************************************************************************/
 #define PRJ_WIFI_STA_TOUT          (5000U)
-#define PRJ_WIFI_STA_BIT_CONNECTED (BIT0)
-#define PRJ_WIFI_STA_BIT_FAIL      (BIT1)
 
 #define PRJ_WIFI_STA_SSID          (CONFIG_WIFI_STA_SSID)
 #define PRJ_WIFI_STA_PASSWORD      (CONFIG_WIFI_STA_PASSWORD)
 #define PRJ_WIFI_STA_MAXIMUM_RETRY (CONFIG_WIFI_STA_MAXIMUM_RETRY)
+#define PRJ_WIFI_STA_BACKOFF_BASE  (CONFIG_WIFI_STA_BACKOFF_BASE_MS * 1000U)
+#define PRJ_WIFI_STA_BACKOFF_MAX   (CONFIG_WIFI_STA_BACKOFF_MAX_MS * 1000U)
+
+#if CONFIG_WIFI_STA_ROAM
+#define PRJ_WIFI_STA_ROAM_SAMPLE    (CONFIG_WIFI_STA_ROAM_SAMPLE_MS * 1000U)
+#define PRJ_WIFI_STA_ROAM_SCAN_MIN  (CONFIG_WIFI_STA_ROAM_SCAN_MIN_S * 1000000U)
+#define PRJ_WIFI_STA_ROAM_SCAN_MAX  (CONFIG_WIFI_STA_ROAM_SCAN_MAX_S * 1000000U)
+#define PRJ_WIFI_STA_ROAM_CACHE_TTL (60U * 1000000U)  /* Scan results older than this do not pick the AP */
+#define PRJ_WIFI_STA_ROAM_BAN       (300U * 1000000U) /* A pinned AP that did not answer is skipped this long */
+#endif
 
 #if CONFIG_WIFI_STA_WPA3_SAE_PWE_HUNT_AND_PECK
 #define PRJ_WIFI_STA_SAE_MODE       (WPA3_SAE_PWE_HUNT_AND_PECK)
@@ -60,24 +73,107 @@
 /***************************************************************************************************
  * Types
  **************************************************************************************************/
+typedef struct
+{
+    prj_wifi_sta_cb_t cb;
+    void *p_ctx;
+} wifi_sta_cb_entry_t;
 /***************************************************************************************************
  * Static functions declaration
  **************************************************************************************************/
+static void wifi_sta_teardown (void);
 static void wifi_sta_event_handler (void *const p_arg, const esp_event_base_t event_base, const prj_i32_t event_id, void *const p_event_data);
+static void wifi_sta_notify (const prj_wifi_sta_event_t event);
+static void wifi_sta_rc_feed (const prj_wifi_sta_rc_input_t input);
+static void wifi_sta_rc_timer_cb (void *p_arg);
+static void wifi_sta_metrics_disconnected (const prj_u8_t reason);
+#if CONFIG_WIFI_STA_ROAM
+static void wifi_sta_roam_feed (prj_wifi_sta_roam_input_t *const p_input);
+static void wifi_sta_roam_timer_cb (void *p_arg);
+static void wifi_sta_roam_scan_done (void);
+#endif
 /***************************************************************************************************
  * Variables
  **************************************************************************************************/
+static StaticEventGroup_t m_wifi_sta_event_group_buf;
 static EventGroupHandle_t m_wifi_sta_event_group = NULL;
-static prj_u8_t m_retry_count = 0U;
+static esp_netif_t *m_netif = NULL;
+static prj_bool_t m_wifi_init = false;
+static esp_event_handler_instance_t m_instance_any_id = NULL;
+static esp_event_handler_instance_t m_instance_got_ip = NULL;
+static esp_event_handler_instance_t m_instance_lost_ip = NULL;
+static esp_timer_handle_t m_rc_timer = NULL;
+static prj_wifi_sta_rc_t m_rc = {0};
+static prj_bool_t m_rc_stopped = false;
+static portMUX_TYPE m_rc_lock = portMUX_INITIALIZER_UNLOCKED;
+#if CONFIG_WIFI_STA_ROAM
+static esp_timer_handle_t m_roam_timer = NULL;
+static prj_wifi_sta_roam_t m_roam = {0}; /* Guarded by m_rc_lock, stopped together with the reconnects */
+static wifi_ap_record_t m_roam_records[PRJ_WIFI_STA_ROAM_CACHE_MAX]; /* Event loop task only */
+#endif
+static prj_i64_t m_connect_start_us = 0; /* First attempt of the current outage, 0 while connected */
+
+static wifi_sta_cb_entry_t m_cb_table[PRJ_WIFI_STA_CB_MAX] = {0};
+static prj_u8_t m_cb_count = 0U;
+static portMUX_TYPE m_cb_lock = portMUX_INITIALIZER_UNLOCKED;
 /***************************************************************************************************
  * API
  **************************************************************************************************/
-void prj_wifi_sta_init (void)
+prj_status_t prj_wifi_sta_cb_register (const prj_wifi_sta_cb_t cb, void *const p_ctx)
+{
+    prj_status_t status = PRJ_SUCCESS;
+
+    if (cb == NULL)
+    {
+        return PRJ_ERROR_NULL;
+    }
+
+    portENTER_CRITICAL(&m_cb_lock);
+
+    if (m_cb_count < PRJ_WIFI_STA_CB_MAX)
+    {
+        m_cb_table[m_cb_count].cb    = cb;
+        m_cb_table[m_cb_count].p_ctx = p_ctx;
+        m_cb_count++;
+    }
+    else
+    {
+        status = PRJ_ERROR_RESOURCES;
+    }
+
+    portEXIT_CRITICAL(&m_cb_lock);
+
+    return status;
+}
+
+prj_status_t prj_wifi_sta_start (EventGroupHandle_t *const p_event_group)
 {
     wifi_init_config_t wifi_init_config = WIFI_INIT_CONFIG_DEFAULT();
-    esp_event_handler_instance_t instance_any_id = NULL;
-    esp_event_handler_instance_t instance_got_ip = NULL;
-    EventBits_t bits = 0U;
+    const esp_timer_create_args_t rc_timer_args = {
+        .callback = wifi_sta_rc_timer_cb,
+        .name     = "wifi_sta_rc",
+    };
+    const prj_wifi_sta_rc_config_t rc_config = {
+        .base_us    = PRJ_WIFI_STA_BACKOFF_BASE,
+        .max_us     = PRJ_WIFI_STA_BACKOFF_MAX,
+        .fail_after = PRJ_WIFI_STA_MAXIMUM_RETRY,
+        .p_random   = esp_random,
+    };
+#if CONFIG_WIFI_STA_ROAM
+    const esp_timer_create_args_t roam_timer_args = {
+        .callback = wifi_sta_roam_timer_cb,
+        .name     = "wifi_sta_roam",
+    };
+    const prj_wifi_sta_roam_config_t roam_config = {
+        .scan_rssi     = CONFIG_WIFI_STA_ROAM_SCAN_RSSI,
+        .hysteresis_db = CONFIG_WIFI_STA_ROAM_HYSTERESIS_DB,
+        .scan_min_us   = PRJ_WIFI_STA_ROAM_SCAN_MIN,
+        .scan_max_us   = PRJ_WIFI_STA_ROAM_SCAN_MAX,
+        .cache_ttl_us  = PRJ_WIFI_STA_ROAM_CACHE_TTL,
+        .ban_us        = PRJ_WIFI_STA_ROAM_BAN,
+    };
+#endif
+    esp_err_t err = ESP_OK;
 
     wifi_config_t wifi_config = {
         .sta = {
@@ -86,101 +182,552 @@ void prj_wifi_sta_init (void)
             .threshold.authmode = PRJ_WIFI_STA_SCAN_AUTH_MODE_THRESHOLD,
             .sae_pwe_h2e        = PRJ_WIFI_STA_SAE_MODE,
             .sae_h2e_identifier = PRJ_WIFI_STA_H2E_IDENTIFIER,
+#if CONFIG_WIFI_STA_ROAM
+            /* Without a cached AP the driver scans every channel and joins the strongest AP of the SSID */
+            .scan_method        = WIFI_ALL_CHANNEL_SCAN,
+            .sort_method        = WIFI_CONNECT_AP_BY_SIGNAL,
+#endif
         },
     };
 
-    m_wifi_sta_event_group = xEventGroupCreate ();
+    if (m_wifi_sta_event_group != NULL)
+    {
+        ESP_LOGW (PRJ_WIFI_STA_TAG, "wifi sta start: already started");
+        return PRJ_ERROR_INVALID_STATE;
+    }
+
+    m_wifi_sta_event_group = xEventGroupCreateStatic (&m_wifi_sta_event_group_buf);
+
+    ESP_LOGI (PRJ_WIFI_STA_TAG, "wifi sta start: initializing wifi sta...");
 
+    prj_wifi_sta_rc_init(&m_rc, &rc_config);
+    m_rc_stopped = false;
+    err = esp_timer_create(&rc_timer_args, &m_rc_timer);
+#if CONFIG_WIFI_STA_ROAM
+    prj_wifi_sta_roam_init(&m_roam, &roam_config);
+
+    if (err == ESP_OK)
+    {
+        err = esp_timer_create(&roam_timer_args, &m_roam_timer);
+    }
+#endif
+
+    if (err == ESP_OK)
+    {
+        err = wifi_sta_cache_worker_start();
+    }
+
+    if (err == ESP_OK)
+    {
+        m_netif = esp_netif_create_default_wifi_sta();
+        err = (m_netif != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+    }
+
+    prj_prof_begin(PRJ_PROF_PHASE_WIFI_START);
+
+    if (err == ESP_OK)
+    {
+        err = esp_wifi_init(&wifi_init_config);
+        m_wifi_init = (err == ESP_OK);
+    }
+
+    /* The config is rebuilt on every start and retargeted on misses and roams, none of it belongs in flash */
+    if (err == ESP_OK)
+    {
+        err = esp_wifi_set_storage(WIFI_STORAGE_RAM);
+    }
+
+    if (err == ESP_OK)
+    {
+        err = esp_event_handler_instance_register(WIFI_EVENT,
+                                                  ESP_EVENT_ANY_ID,
+                                                  &wifi_sta_event_handler,
+                                                  NULL,
+                                                  &m_instance_any_id);
+    }
+
+    if (err == ESP_OK)
+    {
+        err = esp_event_handler_instance_register(IP_EVENT,
+                                                  IP_EVENT_STA_GOT_IP,
+                                                  &wifi_sta_event_handler,
+                                                  NULL,
+                                                  &m_instance_got_ip);
+    }
+
+    if (err == ESP_OK)
+    {
+        err = esp_event_handler_instance_register(IP_EVENT,
+                                                  IP_EVENT_STA_LOST_IP,
+                                                  &wifi_sta_event_handler,
+                                                  NULL,
+                                                  &m_instance_lost_ip);
+    }
+
+    if (err == ESP_OK)
+    {
+        wifi_sta_cache_apply(&wifi_config);
+        err = esp_wifi_set_mode(WIFI_MODE_STA);
+    }
+
+    if (err == ESP_OK)
+    {
+        err = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    }
+
+    if (err == ESP_OK)
+    {
+        err = esp_wifi_start();
+    }
+
+#if CONFIG_WIFI_STA_ROAM
+    if (err == ESP_OK)
+    {
+        err = esp_timer_start_periodic(m_roam_timer, PRJ_WIFI_STA_ROAM_SAMPLE);
+    }
+#endif
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGE (PRJ_WIFI_STA_TAG, "wifi sta start: failed: %s", esp_err_to_name(err));
+        wifi_sta_teardown();
+        return PRJ_ERROR_RESOURCES;
+    }
+
+    ESP_LOGI (PRJ_WIFI_STA_TAG, "wifi sta start: wifi sta started");
+
+    if (p_event_group != NULL)
+    {
+        *p_event_group = m_wifi_sta_event_group;
+    }
+
+    return PRJ_SUCCESS;
+}
+
+prj_status_t prj_wifi_sta_deinit (void)
+{
     if (m_wifi_sta_event_group == NULL)
     {
-        ESP_LOGE (PRJ_WIFI_STA_TAG, "wifi sta init: failed to create event group");
-        return;
+        return PRJ_ERROR_INVALID_STATE;
     }
 
-    ESP_LOGI (PRJ_WIFI_STA_TAG, "wifi sta init: initializing wifi sta...");
+    wifi_sta_teardown();
 
-    ESP_ERROR_CHECK(esp_netif_init());
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    ESP_LOGI (PRJ_WIFI_STA_TAG, "wifi sta deinit: wifi sta stopped");
 
-    esp_netif_create_default_wifi_sta();
+    return PRJ_SUCCESS;
+}
 
-    ESP_ERROR_CHECK(esp_wifi_init(&wifi_init_config));
+EventBits_t prj_wifi_sta_wait (const EventBits_t bits, const prj_u32_t timeout_ms)
+{
+    if (m_wifi_sta_event_group == NULL)
+    {
+        return 0U;
+    }
 
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
-                                                        ESP_EVENT_ANY_ID,
-                                                        &wifi_sta_event_handler,
-                                                        NULL,
-                                                        &instance_any_id));
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT,
-                                                        IP_EVENT_STA_GOT_IP,
-                                                        &wifi_sta_event_handler,
-                                                        NULL,
-                                                        &instance_got_ip));
+    return xEventGroupWaitBits(m_wifi_sta_event_group,
+                               bits,
+                               pdFALSE,
+                               pdFALSE,
+                               pdMS_TO_TICKS(timeout_ms));
+}
 
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
-    ESP_ERROR_CHECK(esp_wifi_start());
+prj_status_t prj_wifi_sta_init (void)
+{
+    prj_status_t status = PRJ_SUCCESS;
+    EventBits_t bits = 0U;
 
-    ESP_LOGI (PRJ_WIFI_STA_TAG, "wifi sta init: wifi sta init finished");
+    status = prj_wifi_sta_start(NULL);
+
+    if (status != PRJ_SUCCESS)
+    {
+        return status;
+    }
 
-    bits = xEventGroupWaitBits(m_wifi_sta_event_group,
-                                PRJ_WIFI_STA_BIT_CONNECTED | PRJ_WIFI_STA_BIT_FAIL,
-                                pdFALSE,
-                                pdFALSE,
-                                PRJ_WIFI_STA_TOUT);
+    bits = prj_wifi_sta_wait(PRJ_WIFI_STA_BIT_GOT_IP | PRJ_WIFI_STA_BIT_FAIL, PRJ_WIFI_STA_TOUT);
 
-    if (bits & PRJ_WIFI_STA_BIT_CONNECTED) 
+    if (bits & PRJ_WIFI_STA_BIT_GOT_IP) 
     {
-        ESP_LOGI(PRJ_WIFI_STA_TAG, "wifi sta init: connected to ap ssid:%s password:%s", PRJ_WIFI_STA_SSID, PRJ_WIFI_STA_PASSWORD);
-        prj_time_sync_once();
+        ESP_LOGI(PRJ_WIFI_STA_TAG, "wifi sta init: connected to ap");
     } 
     else if (bits & PRJ_WIFI_STA_BIT_FAIL) 
     {
-        ESP_LOGI(PRJ_WIFI_STA_TAG, "wifi sta init: failed to connect to ssid:%s, password:%s", PRJ_WIFI_STA_SSID, PRJ_WIFI_STA_PASSWORD);
+        ESP_LOGI(PRJ_WIFI_STA_TAG, "wifi sta init: failed to connect to ap");
     } 
     else 
     {
-        ESP_LOGE(PRJ_WIFI_STA_TAG, "wifi sta init: unexpected event");
+        ESP_LOGW(PRJ_WIFI_STA_TAG, "wifi sta init: not connected yet, continuing in the background");
     }
 
-    return;
+    /* The station keeps reconnecting on its own, so only a failed start is an error */
+    return PRJ_SUCCESS;
 }
 /***************************************************************************************************
  * STATIC
  **************************************************************************************************/
+static void wifi_sta_teardown (void)
+{
+    /* No more events and no more reconnect actions, then in reverse start order. A failed start
+     * leaves the later steps undone, only what was created is released */
+    if (m_instance_lost_ip != NULL)
+    {
+        esp_event_handler_instance_unregister(IP_EVENT, IP_EVENT_STA_LOST_IP, m_instance_lost_ip);
+        m_instance_lost_ip = NULL;
+    }
+
+    if (m_instance_got_ip != NULL)
+    {
+        esp_event_handler_instance_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, m_instance_got_ip);
+        m_instance_got_ip = NULL;
+    }
+
+    if (m_instance_any_id != NULL)
+    {
+        esp_event_handler_instance_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, m_instance_any_id);
+        m_instance_any_id = NULL;
+    }
+
+    /* Cancels a pending retry and reports the link down, later timer callbacks are ignored */
+    wifi_sta_rc_feed(PRJ_WIFI_STA_RC_INPUT_STOP);
+
+    if (m_rc_timer != NULL)
+    {
+        esp_timer_stop(m_rc_timer);
+        esp_timer_delete(m_rc_timer);
+        m_rc_timer = NULL;
+    }
+#if CONFIG_WIFI_STA_ROAM
+    if (m_roam_timer != NULL)
+    {
+        esp_timer_stop(m_roam_timer);
+        esp_timer_delete(m_roam_timer);
+        m_roam_timer = NULL;
+    }
+#endif
+
+    if (m_wifi_init)
+    {
+        esp_wifi_stop();
+        esp_wifi_deinit();
+        m_wifi_init = false;
+    }
+
+    if (m_netif != NULL)
+    {
+        esp_netif_destroy_default_wifi(m_netif);
+        m_netif = NULL;
+    }
+
+    /* No events anymore, a cache update the worker did not get to is written here */
+    wifi_sta_cache_worker_stop();
+
+    vEventGroupDelete(m_wifi_sta_event_group);
+    m_wifi_sta_event_group = NULL;
+
+    return;
+}
+
 static void wifi_sta_event_handler (void *const p_arg, const esp_event_base_t event_base, const prj_i32_t event_id, void *const p_event_data)
 {
     ip_event_got_ip_t* event = NULL;
+    int rssi = 0; /* esp_wifi_sta_get_rssi() takes a plain int */
+#if CONFIG_WIFI_STA_ROAM
+    prj_wifi_sta_roam_input_t roam_input = {0};
+#endif
 
     if ((event_base == WIFI_EVENT) && (event_id == WIFI_EVENT_STA_START)) 
     {
-        esp_wifi_connect();
+        prj_prof_end(PRJ_PROF_PHASE_WIFI_START);
+        m_connect_start_us = esp_timer_get_time();
+        wifi_sta_rc_feed(PRJ_WIFI_STA_RC_INPUT_START);
+    } 
+    else if ((event_base == WIFI_EVENT) && (event_id == WIFI_EVENT_STA_CONNECTED)) 
+    {
+        prj_prof_end(PRJ_PROF_PHASE_ASSOC);
+        prj_prof_begin(PRJ_PROF_PHASE_DHCP);
+        wifi_sta_cache_on_connected((const wifi_event_sta_connected_t *)p_event_data);
+#if CONFIG_WIFI_STA_ROAM
+        roam_input.type = PRJ_WIFI_STA_ROAM_INPUT_CONNECTED;
+        roam_input.p_bssid = ((const wifi_event_sta_connected_t *)p_event_data)->bssid;
+        wifi_sta_roam_feed(&roam_input);
+#endif
+        xEventGroupSetBits(m_wifi_sta_event_group, PRJ_WIFI_STA_BIT_CONNECTED);
+        wifi_sta_notify(PRJ_WIFI_STA_EVENT_CONNECTED);
+        wifi_sta_rc_feed(PRJ_WIFI_STA_RC_INPUT_CONNECTED);
     } 
     else if ((event_base == WIFI_EVENT) && (event_id == WIFI_EVENT_STA_DISCONNECTED)) 
     {
-        if (m_retry_count < PRJ_WIFI_STA_MAXIMUM_RETRY) 
+        xEventGroupClearBits(m_wifi_sta_event_group, PRJ_WIFI_STA_BIT_CONNECTED);
+        wifi_sta_cache_on_disconnected();
+        PRJ_LOG(WIFI_STA_DISCONNECTED, ((const wifi_event_sta_disconnected_t *)p_event_data)->reason);
+        wifi_sta_metrics_disconnected(((const wifi_event_sta_disconnected_t *)p_event_data)->reason);
+#if CONFIG_WIFI_STA_ROAM
+        roam_input.type = PRJ_WIFI_STA_ROAM_INPUT_DISCONNECTED;
+        wifi_sta_roam_feed(&roam_input);
+#endif
+        wifi_sta_rc_feed(PRJ_WIFI_STA_RC_INPUT_DISCONNECTED);
+    } 
+    else if ((event_base == IP_EVENT) && (event_id == IP_EVENT_STA_GOT_IP))
+    {
+        prj_prof_end(PRJ_PROF_PHASE_DHCP);
+        event = (ip_event_got_ip_t*) p_event_data;
+        PRJ_LOG(WIFI_STA_GOT_IP, PRJ_LOG_IP4(event->ip_info.ip.addr));
+        wifi_sta_cache_on_got_ip(&event->ip_info);
+        PRJ_METRICS_ADD(WIFI_STA_CONNECTS, 1U);
+        PRJ_METRICS_SET(WIFI_STA_CONNECT_MS, (prj_i32_t)((esp_timer_get_time() - m_connect_start_us) / 1000));
+        m_connect_start_us = 0;
+
+        if (esp_wifi_sta_get_rssi(&rssi) == ESP_OK)
+        {
+            PRJ_METRICS_SET(WIFI_STA_RSSI, rssi);
+        }
+
+        xEventGroupClearBits(m_wifi_sta_event_group, PRJ_WIFI_STA_BIT_LOST_IP | PRJ_WIFI_STA_BIT_FAIL);
+        xEventGroupSetBits(m_wifi_sta_event_group, PRJ_WIFI_STA_BIT_GOT_IP);
+        wifi_sta_notify(PRJ_WIFI_STA_EVENT_GOT_IP);
+        wifi_sta_rc_feed(PRJ_WIFI_STA_RC_INPUT_GOT_IP);
+    }
+    else if ((event_base == IP_EVENT) && (event_id == IP_EVENT_STA_LOST_IP))
+    {
+        PRJ_LOG(WIFI_STA_LOST_IP);
+        m_connect_start_us = (m_connect_start_us == 0) ? esp_timer_get_time() : m_connect_start_us;
+        xEventGroupClearBits(m_wifi_sta_event_group, PRJ_WIFI_STA_BIT_GOT_IP);
+        xEventGroupSetBits(m_wifi_sta_event_group, PRJ_WIFI_STA_BIT_LOST_IP);
+        wifi_sta_notify(PRJ_WIFI_STA_EVENT_LOST_IP);
+        wifi_sta_rc_feed(PRJ_WIFI_STA_RC_INPUT_LOST_IP);
+    }
+#if CONFIG_WIFI_STA_ROAM
+    else if ((event_base == WIFI_EVENT) && (event_id == WIFI_EVENT_SCAN_DONE))
+    {
+        wifi_sta_roam_scan_done();
+    }
+#endif
+
+    return;
+}
+
+static void wifi_sta_notify (const prj_wifi_sta_event_t event)
+{
+    prj_u8_t count = 0U;
+
+    portENTER_CRITICAL(&m_cb_lock);
+    count = m_cb_count;
+    portEXIT_CRITICAL(&m_cb_lock);
+
+    for (prj_u8_t i = 0U; i < count; i++)
+    {
+        m_cb_table[i].cb(event, m_cb_table[i].p_ctx);
+    }
+
+    return;
+}
+
+static void wifi_sta_rc_feed (const prj_wifi_sta_rc_input_t input)
+{
+    prj_wifi_sta_rc_output_t out = {0};
+
+    /* Fed from both the event loop task and the esp_timer task */
+    portENTER_CRITICAL(&m_rc_lock);
+    if (!m_rc_stopped)
+    {
+        out = prj_wifi_sta_rc_step(&m_rc, input);
+        m_rc_stopped = (input == PRJ_WIFI_STA_RC_INPUT_STOP);
+    }
+    portEXIT_CRITICAL(&m_rc_lock);
+
+    if ((out.actions & PRJ_WIFI_STA_RC_ACTION_CANCEL_TIMER) && (m_rc_timer != NULL))
+    {
+        esp_timer_stop(m_rc_timer);
+    }
+
+    if (out.actions & PRJ_WIFI_STA_RC_ACTION_LINK_DOWN)
+    {
+        wifi_sta_notify(PRJ_WIFI_STA_EVENT_LINK_DOWN);
+    }
+
+    if (out.actions & PRJ_WIFI_STA_RC_ACTION_LINK_UP)
+    {
+        wifi_sta_notify(PRJ_WIFI_STA_EVENT_LINK_UP);
+    }
+
+    if (out.actions & PRJ_WIFI_STA_RC_ACTION_FAILED)
+    {
+        xEventGroupSetBits(m_wifi_sta_event_group, PRJ_WIFI_STA_BIT_FAIL);
+        wifi_sta_notify(PRJ_WIFI_STA_EVENT_FAILED);
+    }
+
+    if (out.actions & PRJ_WIFI_STA_RC_ACTION_ARM_TIMER)
+    {
+        PRJ_LOG(WIFI_STA_RETRY, (prj_u32_t)(out.delay_us / 1000U));
+        PRJ_METRICS_ADD(WIFI_STA_RETRIES, 1U);
+        esp_timer_stop(m_rc_timer);
+        esp_timer_start_once(m_rc_timer, out.delay_us);
+    }
+
+    if (out.actions & PRJ_WIFI_STA_RC_ACTION_CONNECT)
+    {
+        prj_prof_begin(PRJ_PROF_PHASE_ASSOC);
+#if CONFIG_WIFI_STA_ROAM
+        wifi_sta_roam_feed(&(prj_wifi_sta_roam_input_t){.type = PRJ_WIFI_STA_ROAM_INPUT_CONNECT});
+#endif
+        esp_wifi_connect();
+    }
+
+    return;
+}
+
+static void wifi_sta_rc_timer_cb (void *p_arg)
+{
+    wifi_sta_rc_feed(PRJ_WIFI_STA_RC_INPUT_TIMER);
+
+    return;
+}
+
+static void wifi_sta_metrics_disconnected (const prj_u8_t reason)
+{
+    PRJ_METRICS_ADD(WIFI_STA_DISCONNECTS, 1U);
+    PRJ_METRICS_SET(WIFI_STA_LAST_REASON, reason);
+    m_connect_start_us = (m_connect_start_us == 0) ? esp_timer_get_time() : m_connect_start_us;
+
+    switch (reason)
+    {
+        case WIFI_REASON_BEACON_TIMEOUT:
+            PRJ_METRICS_ADD(WIFI_STA_DISC_BEACON, 1U);
+            break;
+
+        case WIFI_REASON_NO_AP_FOUND:
+            PRJ_METRICS_ADD(WIFI_STA_DISC_NO_AP, 1U);
+            break;
+
+        case WIFI_REASON_AUTH_FAIL:
+        case WIFI_REASON_HANDSHAKE_TIMEOUT:
+            PRJ_METRICS_ADD(WIFI_STA_DISC_AUTH, 1U);
+            break;
+
+        default:
+            break;
+    }
+
+    return;
+}
+
+#if CONFIG_WIFI_STA_ROAM
+static void wifi_sta_roam_feed (prj_wifi_sta_roam_input_t *const p_input)
+{
+    prj_wifi_sta_roam_output_t out = {0};
+    wifi_config_t config = {0};
+    const wifi_scan_config_t scan_config = {
+        .ssid        = (prj_u8_t *)PRJ_WIFI_STA_SSID,
+        .show_hidden = false,
+        .scan_type   = WIFI_SCAN_TYPE_ACTIVE,
+    };
+
+    p_input->now_us = esp_timer_get_time();
+
+    /* Fed from the event loop task and the esp_timer task, same as the reconnects */
+    portENTER_CRITICAL(&m_rc_lock);
+    if (!m_rc_stopped)
+    {
+        out = prj_wifi_sta_roam_step(&m_roam, p_input);
+    }
+    portEXIT_CRITICAL(&m_rc_lock);
+
+    if ((out.actions & (PRJ_WIFI_STA_ROAM_ACTION_PIN | PRJ_WIFI_STA_ROAM_ACTION_UNPIN)) &&
+        (esp_wifi_get_config(WIFI_IF_STA, &config) == ESP_OK))
+    {
+        if (out.actions & PRJ_WIFI_STA_ROAM_ACTION_PIN)
         {
-            esp_wifi_connect();
-            m_retry_count++;
-            ESP_LOGI(PRJ_WIFI_STA_TAG, "wifi sta event handler: retry to connect to the AP");
-        } 
-        else 
+            memcpy(config.sta.bssid, out.target.bssid, sizeof(config.sta.bssid));
+            config.sta.bssid_set = true;
+            config.sta.channel = out.target.channel;
+            config.sta.scan_method = WIFI_FAST_SCAN;
+        }
+        else
         {
-            xEventGroupSetBits(m_wifi_sta_event_group, PRJ_WIFI_STA_BIT_FAIL);
+            config.sta.bssid_set = false;
+            config.sta.channel = 0U;
+            config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
         }
 
-        ESP_LOGI(PRJ_WIFI_STA_TAG, "wifi sta event handler: connect to the AP fail");
-    } 
-    else if ((event_base == IP_EVENT) && (event_id == IP_EVENT_STA_GOT_IP))
+        esp_wifi_set_config(WIFI_IF_STA, &config);
+    }
+
+    if (out.actions & PRJ_WIFI_STA_ROAM_ACTION_MISS)
     {
-        event = (ip_event_got_ip_t*) p_event_data;
-        ESP_LOGI(PRJ_WIFI_STA_TAG, "wifi sta event handler: got ip:" IPSTR, IP2STR(&event->ip_info.ip));
-        m_retry_count = 0;
-        xEventGroupSetBits(m_wifi_sta_event_group, PRJ_WIFI_STA_BIT_CONNECTED);
+        PRJ_LOG(WIFI_STA_ROAM_MISS);
+    }
+
+    /* A failed start needs no cleanup, the decision logic already holds off the next scan */
+    if ((out.actions & PRJ_WIFI_STA_ROAM_ACTION_SCAN) && (esp_wifi_scan_start(&scan_config, false) == ESP_OK))
+    {
+        PRJ_METRICS_ADD(WIFI_STA_ROAM_SCANS, 1U);
+    }
+
+    if (out.actions & PRJ_WIFI_STA_ROAM_ACTION_DISCONNECT)
+    {
+        PRJ_LOG(WIFI_STA_ROAM, out.target.bssid[PRJ_WIFI_STA_ROAM_BSSID_LEN - 1U], out.target.channel,
+                (prj_u32_t)(prj_i32_t)out.target.rssi);
+        PRJ_METRICS_ADD(WIFI_STA_ROAMS, 1U);
+        wifi_sta_rc_feed(PRJ_WIFI_STA_RC_INPUT_ROAM);
+        esp_wifi_disconnect();
+    }
+
+    return;
+}
+
+static void wifi_sta_roam_timer_cb (void *p_arg)
+{
+    prj_wifi_sta_roam_input_t input = {
+        .type = PRJ_WIFI_STA_ROAM_INPUT_RSSI,
+    };
+    int rssi = 0;
+
+    /* Fails while not associated, there is nothing to judge then */
+    if (esp_wifi_sta_get_rssi(&rssi) != ESP_OK)
+    {
+        return;
     }
 
+    PRJ_METRICS_SET(WIFI_STA_RSSI, rssi);
+    input.rssi = (prj_i8_t)rssi;
+    wifi_sta_roam_feed(&input);
+
     return;
 }
+
+static void wifi_sta_roam_scan_done (void)
+{
+    prj_wifi_sta_roam_ap_t aps[PRJ_WIFI_STA_ROAM_CACHE_MAX] = {0};
+    prj_wifi_sta_roam_input_t input = {
+        .type  = PRJ_WIFI_STA_ROAM_INPUT_SCAN_DONE,
+        .p_aps = aps,
+    };
+    prj_u16_t number = PRJ_WIFI_STA_ROAM_CACHE_MAX;
+
+    /* Fetching frees the driver list, on failure it has to be dropped explicitly */
+    if (esp_wifi_scan_get_ap_records(&number, m_roam_records) != ESP_OK)
+    {
+        esp_wifi_clear_ap_list();
+        number = 0U;
+    }
+
+    /* The scan was for our SSID, only the security level still has to match the connect threshold */
+    for (prj_u16_t i = 0U; i < number; i++)
+    {
+        if (m_roam_records[i].authmode >= PRJ_WIFI_STA_SCAN_AUTH_MODE_THRESHOLD)
+        {
+            memcpy(aps[input.count].bssid, m_roam_records[i].bssid, sizeof(aps[input.count].bssid));
+            aps[input.count].channel = m_roam_records[i].primary;
+            aps[input.count].rssi = m_roam_records[i].rssi;
+            input.count++;
+        }
+    }
+
+    wifi_sta_roam_feed(&input);
+
+    return;
+}
+#endif
 /***************************************************************************************************
  * EOF
  **************************************************************************************************/
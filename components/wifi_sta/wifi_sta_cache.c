@@ -0,0 +1,416 @@
+/**
+ * @file wifi_sta_cache.c
+ * @date 05/16/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "wifi_sta_priv.h"
+#include "prj_log.h"
+
+#include <string.h>
+#include <stddef.h>
+#include "esp_attr.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_WIFI_STA_CACHE_MAGIC        (0x57534331U) /* "WSC1" */
+#define PRJ_WIFI_STA_NVS_NAMESPACE      "wifi_sta"
+#define PRJ_WIFI_STA_NVS_KEY_CACHE      "cache"
+#define PRJ_WIFI_STA_SSID_LEN           (32U)
+#define PRJ_WIFI_STA_BSSID_LEN          (6U)
+#define PRJ_WIFI_STA_CACHE_TASK_NAME    "wifi_sta_cache"
+#define PRJ_WIFI_STA_CACHE_TASK_STACK   (3072U)
+#define PRJ_WIFI_STA_CACHE_TASK_PRIO    (1U)
+#define PRJ_WIFI_STA_CACHE_STOP_POLL_MS (10U)
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    prj_u32_t magic;
+    prj_u8_t ssid[PRJ_WIFI_STA_SSID_LEN];   /*!< Cache is only valid for the SSID it was taken with */
+    prj_u8_t bssid[PRJ_WIFI_STA_BSSID_LEN];
+    prj_u8_t channel;
+    prj_u8_t authmode;
+    esp_netif_ip_info_t ip_info;            /*!< Last DHCP lease */
+    prj_u32_t checksum;
+} wifi_sta_cache_t;
+
+typedef enum
+{
+    PRJ_WIFI_STA_CACHE_OP_NONE = 0,
+    PRJ_WIFI_STA_CACHE_OP_STORE,
+    PRJ_WIFI_STA_CACHE_OP_ERASE,
+} wifi_sta_cache_op_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static prj_bool_t wifi_sta_cache_load(wifi_sta_cache_t *const p_cache);
+static void wifi_sta_cache_task(void *p_arg);
+static void wifi_sta_cache_post(const wifi_sta_cache_op_t op);
+static void wifi_sta_cache_flush(void);
+static void wifi_sta_cache_store(wifi_sta_cache_t *const p_cache);
+static prj_u32_t wifi_sta_cache_checksum(const wifi_sta_cache_t *const p_cache);
+static prj_bool_t wifi_sta_cache_nvs_open(const nvs_open_mode_t mode, nvs_handle_t *const p_handle);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+/* Kept across deep sleep, so the rates cover many wake cycles */
+static RTC_DATA_ATTR prj_wifi_sta_cache_stats_t m_stats;
+
+static wifi_sta_cache_t m_cache = {0};
+static prj_bool_t m_cache_valid = false;
+static prj_bool_t m_targeted = false;
+static prj_bool_t m_first_join = false; /* No association since the cache was applied */
+static prj_bool_t m_associated = false;
+
+/* Flash writes are left to a worker, the event loop only posts the latest record */
+static StaticTask_t m_task_buf;
+static StackType_t m_task_stack[PRJ_WIFI_STA_CACHE_TASK_STACK];
+static TaskHandle_t m_task = NULL;
+static volatile prj_bool_t m_stop = false;
+static volatile prj_bool_t m_stopped = false;
+static volatile prj_u32_t m_notifiers = 0U; /* Posters between taking the task handle and notifying it */
+static wifi_sta_cache_op_t m_pending = PRJ_WIFI_STA_CACHE_OP_NONE;
+static wifi_sta_cache_t m_pending_cache = {0};
+static portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+prj_status_t prj_wifi_sta_cache_stats_get(prj_wifi_sta_cache_stats_t *const p_stats)
+{
+    if (p_stats == NULL)
+    {
+        return PRJ_ERROR_NULL;
+    }
+
+    *p_stats = m_stats;
+
+    return PRJ_SUCCESS;
+}
+
+void wifi_sta_cache_apply(wifi_config_t *const p_config)
+{
+    m_targeted = false;
+    m_first_join = false;
+    m_associated = false;
+    m_cache_valid = wifi_sta_cache_load(&m_cache) &&
+                    (memcmp(m_cache.ssid, p_config->sta.ssid, sizeof(m_cache.ssid)) == 0);
+
+    if (!m_cache_valid)
+    {
+        ESP_LOGI(PRJ_WIFI_STA_TAG, "wifi sta cache: no cached ap, full scan");
+        return;
+    }
+
+    /* Go straight to the known AP on its channel instead of scanning all channels */
+    memcpy(p_config->sta.bssid, m_cache.bssid, sizeof(p_config->sta.bssid));
+    p_config->sta.bssid_set = true;
+    p_config->sta.channel = m_cache.channel;
+    p_config->sta.scan_method = WIFI_FAST_SCAN;
+    m_targeted = true;
+    m_first_join = true;
+
+    ESP_LOGI(PRJ_WIFI_STA_TAG, "wifi sta cache: targeted connect on channel %u", m_cache.channel);
+
+    return;
+}
+
+void wifi_sta_cache_on_connected(const wifi_event_sta_connected_t *const p_event)
+{
+    m_associated = true;
+
+    /* Later reassociations go to the same AP anyway, only the first one shows the cache worked */
+    if (m_targeted && m_first_join)
+    {
+        m_stats.ap_hit++;
+    }
+
+    m_first_join = false;
+
+    if (!m_cache_valid ||
+        (memcmp(m_cache.bssid, p_event->bssid, sizeof(m_cache.bssid)) != 0) ||
+        (m_cache.channel != p_event->channel) ||
+        (m_cache.authmode != (prj_u8_t)p_event->authmode))
+    {
+        memset(m_cache.ssid, 0, sizeof(m_cache.ssid));
+        memcpy(m_cache.ssid, p_event->ssid, (p_event->ssid_len < sizeof(m_cache.ssid)) ? p_event->ssid_len : sizeof(m_cache.ssid));
+        memcpy(m_cache.bssid, p_event->bssid, sizeof(m_cache.bssid));
+        m_cache.channel = p_event->channel;
+        m_cache.authmode = (prj_u8_t)p_event->authmode;
+        m_cache_valid = false; /* Stored once the lease is known */
+    }
+
+    return;
+}
+
+void wifi_sta_cache_on_disconnected(void)
+{
+    wifi_config_t config = {0};
+    prj_bool_t associated = m_associated;
+
+    m_associated = false;
+
+    if (!m_targeted || associated)
+    {
+        return;
+    }
+
+    /* The cached AP did not answer: drop the cache and fall back to a full scan */
+    m_stats.ap_miss++;
+    m_targeted = false;
+    m_first_join = false;
+    m_cache_valid = false;
+    wifi_sta_cache_post(PRJ_WIFI_STA_CACHE_OP_ERASE);
+
+    if (esp_wifi_get_config(WIFI_IF_STA, &config) == ESP_OK)
+    {
+        config.sta.bssid_set = false;
+        config.sta.channel = 0U;
+        config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        esp_wifi_set_config(WIFI_IF_STA, &config);
+    }
+
+    PRJ_LOG(WIFI_STA_CACHE_MISS);
+
+    return;
+}
+
+void wifi_sta_cache_on_got_ip(const esp_netif_ip_info_t *const p_ip_info)
+{
+    if (m_cache_valid && (m_cache.ip_info.ip.addr == p_ip_info->ip.addr))
+    {
+        m_stats.lease_hit++;
+    }
+    else
+    {
+        m_stats.lease_miss++;
+    }
+
+    if (m_cache_valid && (memcmp(&m_cache.ip_info, p_ip_info, sizeof(m_cache.ip_info)) == 0))
+    {
+        return;
+    }
+
+    m_cache.ip_info = *p_ip_info;
+    m_cache_valid = true;
+    wifi_sta_cache_post(PRJ_WIFI_STA_CACHE_OP_STORE);
+
+    return;
+}
+
+esp_err_t wifi_sta_cache_worker_start(void)
+{
+    if (m_task != NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    m_stop = false;
+    m_stopped = false;
+
+    m_task = xTaskCreateStatic(wifi_sta_cache_task, PRJ_WIFI_STA_CACHE_TASK_NAME, PRJ_WIFI_STA_CACHE_TASK_STACK,
+                               NULL, PRJ_WIFI_STA_CACHE_TASK_PRIO, m_task_stack, &m_task_buf);
+
+    return (m_task != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void wifi_sta_cache_worker_stop(void)
+{
+    TaskHandle_t task = m_task;
+
+    if (task != NULL)
+    {
+        portENTER_CRITICAL(&m_lock);
+        m_task = NULL;
+        portEXIT_CRITICAL(&m_lock);
+
+        /* A poster may still hold the handle it took before it was cleared */
+        while (m_notifiers != 0U)
+        {
+            vTaskDelay(pdMS_TO_TICKS(PRJ_WIFI_STA_CACHE_STOP_POLL_MS));
+        }
+
+        m_stop = true;
+        xTaskNotifyGive(task);
+
+        /* A write in progress finishes first. The static task memory is free again only once deleted */
+        while (!m_stopped || (eTaskGetState(task) != eSuspended))
+        {
+            vTaskDelay(pdMS_TO_TICKS(PRJ_WIFI_STA_CACHE_STOP_POLL_MS));
+        }
+
+        vTaskDelete(task);
+    }
+
+    /* Whatever the worker did not get to yet */
+    wifi_sta_cache_flush();
+
+    return;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void wifi_sta_cache_task(void *p_arg)
+{
+    while (!m_stop)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        wifi_sta_cache_flush();
+    }
+
+    /* Deleted by wifi_sta_cache_worker_stop(), which waits for the suspension */
+    m_stopped = true;
+    vTaskSuspend(NULL);
+}
+
+static void wifi_sta_cache_post(const wifi_sta_cache_op_t op)
+{
+    TaskHandle_t task = NULL;
+
+    /* Only the latest record counts, a store after a miss replaces the erase */
+    portENTER_CRITICAL(&m_lock);
+    m_pending = op;
+    m_pending_cache = m_cache;
+    task = m_task;
+    m_notifiers += (task != NULL) ? 1U : 0U;
+    portEXIT_CRITICAL(&m_lock);
+
+    if (task == NULL)
+    {
+        return;
+    }
+
+    xTaskNotifyGive(task);
+
+    portENTER_CRITICAL(&m_lock);
+    m_notifiers--;
+    portEXIT_CRITICAL(&m_lock);
+
+    return;
+}
+
+static void wifi_sta_cache_flush(void)
+{
+    wifi_sta_cache_t cache = {0};
+    wifi_sta_cache_op_t op = PRJ_WIFI_STA_CACHE_OP_NONE;
+
+    portENTER_CRITICAL(&m_lock);
+    op = m_pending;
+    cache = m_pending_cache;
+    m_pending = PRJ_WIFI_STA_CACHE_OP_NONE;
+    portEXIT_CRITICAL(&m_lock);
+
+    if (op != PRJ_WIFI_STA_CACHE_OP_NONE)
+    {
+        wifi_sta_cache_store((op == PRJ_WIFI_STA_CACHE_OP_STORE) ? &cache : NULL);
+    }
+
+    return;
+}
+
+static prj_bool_t wifi_sta_cache_load(wifi_sta_cache_t *const p_cache)
+{
+    nvs_handle_t handle = 0;
+    prj_size_t size = sizeof(*p_cache);
+    prj_bool_t valid = false;
+
+    if (!wifi_sta_cache_nvs_open(NVS_READONLY, &handle))
+    {
+        return false;
+    }
+
+    valid = (nvs_get_blob(handle, PRJ_WIFI_STA_NVS_KEY_CACHE, p_cache, &size) == ESP_OK) &&
+            (size == sizeof(*p_cache)) &&
+            (p_cache->magic == PRJ_WIFI_STA_CACHE_MAGIC) &&
+            (p_cache->checksum == wifi_sta_cache_checksum(p_cache));
+
+    nvs_close(handle);
+
+    return valid;
+}
+
+static void wifi_sta_cache_store(wifi_sta_cache_t *const p_cache)
+{
+    nvs_handle_t handle = 0;
+    esp_err_t err = ESP_OK;
+
+    if (!wifi_sta_cache_nvs_open(NVS_READWRITE, &handle))
+    {
+        return;
+    }
+
+    /* No record means the cached AP is gone */
+    if (p_cache == NULL)
+    {
+        err = nvs_erase_key(handle, PRJ_WIFI_STA_NVS_KEY_CACHE);
+        err = (err == ESP_ERR_NVS_NOT_FOUND) ? ESP_OK : err;
+    }
+    else
+    {
+        p_cache->magic = PRJ_WIFI_STA_CACHE_MAGIC;
+        p_cache->checksum = wifi_sta_cache_checksum(p_cache);
+        err = nvs_set_blob(handle, PRJ_WIFI_STA_NVS_KEY_CACHE, p_cache, sizeof(*p_cache));
+    }
+
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(handle);
+    }
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(PRJ_WIFI_STA_TAG, "wifi sta cache: nvs write failed: %s", esp_err_to_name(err));
+    }
+
+    nvs_close(handle);
+
+    return;
+}
+
+static prj_u32_t wifi_sta_cache_checksum(const wifi_sta_cache_t *const p_cache)
+{
+    const prj_u8_t *p_data = (const prj_u8_t *)p_cache;
+    prj_u32_t hash = 2166136261U;
+
+    /* FNV-1a over everything but the checksum itself */
+    for (prj_size_t i = 0U; i < offsetof(wifi_sta_cache_t, checksum); i++)
+    {
+        hash = (hash ^ p_data[i]) * 16777619U;
+    }
+
+    return hash;
+}
+
+static prj_bool_t wifi_sta_cache_nvs_open(const nvs_open_mode_t mode, nvs_handle_t *const p_handle)
+{
+    esp_err_t err = nvs_flash_init();
+
+    if (err == ESP_OK)
+    {
+        err = nvs_open(PRJ_WIFI_STA_NVS_NAMESPACE, mode, p_handle);
+    }
+
+    if ((err != ESP_OK) && (err != ESP_ERR_NVS_NOT_FOUND))
+    {
+        ESP_LOGW(PRJ_WIFI_STA_TAG, "wifi sta cache: nvs unavailable: %s", esp_err_to_name(err));
+    }
+
+    return (err == ESP_OK);
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,39 @@
+/**
+ * @file wifi_sta_priv.h
+ * @date 05/16/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef WIFI_STA_PRIV_H
+#define WIFI_STA_PRIV_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "wifi_sta.h"
+#include "esp_wifi.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/* Fast reconnect cache, wifi_sta_cache.c */
+void wifi_sta_cache_apply(wifi_config_t *const p_config);
+void wifi_sta_cache_on_connected(const wifi_event_sta_connected_t *const p_event);
+void wifi_sta_cache_on_disconnected(void);
+void wifi_sta_cache_on_got_ip(const esp_netif_ip_info_t *const p_ip_info);
+esp_err_t wifi_sta_cache_worker_start(void);
+void wifi_sta_cache_worker_stop(void);
+#endif /* WIFI_STA_PRIV_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,170 @@
+/**
+ * @file wifi_sta_reconnect.c
+ * @date 05/16/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "wifi_sta_reconnect.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_WIFI_STA_RC_SHIFT_MAX (16U)
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static prj_u32_t wifi_sta_rc_backoff_us (const prj_wifi_sta_rc_t *const p_rc);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void prj_wifi_sta_rc_init (prj_wifi_sta_rc_t *const p_rc, const prj_wifi_sta_rc_config_t *const p_config)
+{
+    *p_rc = (prj_wifi_sta_rc_t){0};
+    p_rc->config = *p_config;
+    p_rc->state = PRJ_WIFI_STA_RC_STATE_IDLE;
+
+    return;
+}
+
+prj_wifi_sta_rc_output_t prj_wifi_sta_rc_step (prj_wifi_sta_rc_t *const p_rc, const prj_wifi_sta_rc_input_t input)
+{
+    prj_wifi_sta_rc_output_t out = {0};
+
+    switch (input)
+    {
+        case PRJ_WIFI_STA_RC_INPUT_START:
+            if (p_rc->state == PRJ_WIFI_STA_RC_STATE_IDLE)
+            {
+                p_rc->state = PRJ_WIFI_STA_RC_STATE_CONNECTING;
+                p_rc->attempts++;
+                out.actions = PRJ_WIFI_STA_RC_ACTION_CONNECT;
+            }
+            break;
+
+        case PRJ_WIFI_STA_RC_INPUT_STOP:
+            out.actions = PRJ_WIFI_STA_RC_ACTION_CANCEL_TIMER;
+            out.actions |= p_rc->link_up ? PRJ_WIFI_STA_RC_ACTION_LINK_DOWN : 0U;
+            p_rc->state = PRJ_WIFI_STA_RC_STATE_IDLE;
+            p_rc->failures = 0U;
+            p_rc->link_up = false;
+            p_rc->fail_reported = false;
+            p_rc->roaming = false;
+            break;
+
+        case PRJ_WIFI_STA_RC_INPUT_CONNECTED:
+            if ((p_rc->state == PRJ_WIFI_STA_RC_STATE_CONNECTING) || (p_rc->state == PRJ_WIFI_STA_RC_STATE_BACKOFF))
+            {
+                p_rc->state = PRJ_WIFI_STA_RC_STATE_ASSOCIATED;
+            }
+            break;
+
+        case PRJ_WIFI_STA_RC_INPUT_GOT_IP:
+            if (p_rc->state != PRJ_WIFI_STA_RC_STATE_IDLE)
+            {
+                out.actions = p_rc->link_up ? 0U : PRJ_WIFI_STA_RC_ACTION_LINK_UP;
+                p_rc->state = PRJ_WIFI_STA_RC_STATE_ONLINE;
+                p_rc->failures = 0U;
+                p_rc->link_up = true;
+                p_rc->fail_reported = false;
+            }
+            break;
+
+        case PRJ_WIFI_STA_RC_INPUT_LOST_IP:
+            if (p_rc->state == PRJ_WIFI_STA_RC_STATE_ONLINE)
+            {
+                p_rc->state = PRJ_WIFI_STA_RC_STATE_ASSOCIATED;
+            }
+            break;
+
+        case PRJ_WIFI_STA_RC_INPUT_DISCONNECTED:
+            /* Duplicate disconnects while already backing off must not shorten the wait */
+            if ((p_rc->state == PRJ_WIFI_STA_RC_STATE_IDLE) || (p_rc->state == PRJ_WIFI_STA_RC_STATE_BACKOFF))
+            {
+                break;
+            }
+
+            /* Leaving for a better AP is not a failure: no backoff and the link stays up unless the join fails */
+            if (p_rc->roaming)
+            {
+                p_rc->roaming = false;
+                p_rc->state = PRJ_WIFI_STA_RC_STATE_CONNECTING;
+                p_rc->attempts++;
+                out.actions = PRJ_WIFI_STA_RC_ACTION_CONNECT;
+                break;
+            }
+
+            if (p_rc->link_up)
+            {
+                out.actions |= PRJ_WIFI_STA_RC_ACTION_LINK_DOWN;
+                p_rc->link_up = false;
+            }
+
+            /* Even the first retry is jittered, so devices dropped by the same AP reboot spread out */
+            out.actions |= PRJ_WIFI_STA_RC_ACTION_ARM_TIMER;
+            out.delay_us = wifi_sta_rc_backoff_us(p_rc);
+            p_rc->failures++;
+            p_rc->state = PRJ_WIFI_STA_RC_STATE_BACKOFF;
+
+            if ((p_rc->failures >= p_rc->config.fail_after) && !p_rc->fail_reported)
+            {
+                out.actions |= PRJ_WIFI_STA_RC_ACTION_FAILED;
+                p_rc->fail_reported = true;
+            }
+            break;
+
+        case PRJ_WIFI_STA_RC_INPUT_TIMER:
+            if (p_rc->state == PRJ_WIFI_STA_RC_STATE_BACKOFF)
+            {
+                p_rc->state = PRJ_WIFI_STA_RC_STATE_CONNECTING;
+                p_rc->attempts++;
+                out.actions = PRJ_WIFI_STA_RC_ACTION_CONNECT;
+            }
+            break;
+
+        case PRJ_WIFI_STA_RC_INPUT_ROAM:
+            p_rc->roaming = (p_rc->state == PRJ_WIFI_STA_RC_STATE_ASSOCIATED) || (p_rc->state == PRJ_WIFI_STA_RC_STATE_ONLINE);
+            break;
+
+        default:
+            break;
+    }
+
+    return out;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static prj_u32_t wifi_sta_rc_backoff_us (const prj_wifi_sta_rc_t *const p_rc)
+{
+    prj_u32_t shift = (p_rc->failures < PRJ_WIFI_STA_RC_SHIFT_MAX) ? p_rc->failures : PRJ_WIFI_STA_RC_SHIFT_MAX;
+    prj_u64_t delay_us = (prj_u64_t)p_rc->config.base_us << shift;
+    prj_u32_t half_us = 0U;
+
+    delay_us = (delay_us < p_rc->config.max_us) ? delay_us : p_rc->config.max_us;
+    half_us = (prj_u32_t)(delay_us / 2U);
+
+    /* Equal jitter: half of the delay is fixed, the other half is random */
+    if ((p_rc->config.p_random == NULL) || (half_us == 0U))
+    {
+        return (prj_u32_t)delay_us;
+    }
+
+    return half_us + (p_rc->config.p_random() % (half_us + 1U));
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,304 @@
+/**
+ * @file wifi_sta_roam.c
+ * @date 06/06/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "wifi_sta_roam.h"
+
+#include <string.h>
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_WIFI_STA_ROAM_Q4       (16)   /* Fixed point scale of the smoothed RSSI */
+#define PRJ_WIFI_STA_ROAM_EMA_DIV  (4)    /* Each sample moves the average a quarter of the way */
+#define PRJ_WIFI_STA_ROAM_NONE     (-1)
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void wifi_sta_roam_rssi (prj_wifi_sta_roam_t *const p_roam, const prj_wifi_sta_roam_input_t *const p_input,
+                                prj_wifi_sta_roam_output_t *const p_out);
+static void wifi_sta_roam_scan_done (prj_wifi_sta_roam_t *const p_roam, const prj_wifi_sta_roam_input_t *const p_input,
+                                     prj_wifi_sta_roam_output_t *const p_out);
+static void wifi_sta_roam_merge (prj_wifi_sta_roam_t *const p_roam, const prj_wifi_sta_roam_ap_t *const p_ap,
+                                 const prj_i64_t now_us);
+static prj_i32_t wifi_sta_roam_find (const prj_wifi_sta_roam_t *const p_roam, const prj_u8_t *const p_bssid);
+static prj_i32_t wifi_sta_roam_best (const prj_wifi_sta_roam_t *const p_roam, const prj_i64_t now_us,
+                                     const prj_u8_t *const p_exclude);
+static prj_bool_t wifi_sta_roam_fresh (const prj_wifi_sta_roam_t *const p_roam,
+                                       const prj_wifi_sta_roam_entry_t *const p_entry, const prj_i64_t now_us);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void prj_wifi_sta_roam_init (prj_wifi_sta_roam_t *const p_roam, const prj_wifi_sta_roam_config_t *const p_config)
+{
+    *p_roam = (prj_wifi_sta_roam_t){0};
+    p_roam->config = *p_config;
+    p_roam->join = PRJ_WIFI_STA_ROAM_JOIN_NONE;
+    p_roam->scan_period_us = p_config->scan_min_us;
+
+    return;
+}
+
+prj_wifi_sta_roam_output_t prj_wifi_sta_roam_step (prj_wifi_sta_roam_t *const p_roam,
+                                                   const prj_wifi_sta_roam_input_t *const p_input)
+{
+    prj_wifi_sta_roam_output_t out = {0};
+    prj_i32_t index = PRJ_WIFI_STA_ROAM_NONE;
+
+    switch (p_input->type)
+    {
+        case PRJ_WIFI_STA_ROAM_INPUT_CONNECT:
+            /* A roam already pinned its target, otherwise a fresh cached AP saves the driver a full scan */
+            if (p_roam->join == PRJ_WIFI_STA_ROAM_JOIN_NONE)
+            {
+                index = wifi_sta_roam_best(p_roam, p_input->now_us, NULL);
+            }
+
+            if (index != PRJ_WIFI_STA_ROAM_NONE)
+            {
+                out.actions = PRJ_WIFI_STA_ROAM_ACTION_PIN;
+                out.target = p_roam->cache[index].ap;
+                p_roam->target = out.target;
+                p_roam->join = PRJ_WIFI_STA_ROAM_JOIN_PINNED;
+                p_roam->pinned = true;
+            }
+            break;
+
+        case PRJ_WIFI_STA_ROAM_INPUT_CONNECTED:
+            memcpy(p_roam->bssid, p_input->p_bssid, sizeof(p_roam->bssid));
+            p_roam->associated = true;
+            p_roam->join = PRJ_WIFI_STA_ROAM_JOIN_NONE;
+            p_roam->rssi_valid = false;
+            /* Let the average settle on the new AP before judging it */
+            p_roam->scan_period_us = p_roam->config.scan_min_us;
+            p_roam->scan_due_us = p_input->now_us + p_roam->config.scan_min_us;
+            break;
+
+        case PRJ_WIFI_STA_ROAM_INPUT_DISCONNECTED:
+            p_roam->associated = false;
+            p_roam->rssi_valid = false;
+
+            if (p_roam->join == PRJ_WIFI_STA_ROAM_JOIN_LEAVING)
+            {
+                /* The disconnect we asked for, the reconnect goes to the pinned AP */
+                p_roam->join = PRJ_WIFI_STA_ROAM_JOIN_PINNED;
+            }
+            else if (p_roam->join == PRJ_WIFI_STA_ROAM_JOIN_PINNED)
+            {
+                index = wifi_sta_roam_find(p_roam, p_roam->target.bssid);
+
+                if (index != PRJ_WIFI_STA_ROAM_NONE)
+                {
+                    p_roam->cache[index].banned_us = p_input->now_us + p_roam->config.ban_us;
+                }
+
+                out.actions = PRJ_WIFI_STA_ROAM_ACTION_UNPIN | PRJ_WIFI_STA_ROAM_ACTION_MISS;
+                p_roam->join = PRJ_WIFI_STA_ROAM_JOIN_NONE;
+                p_roam->pinned = false;
+            }
+            else if (p_roam->pinned)
+            {
+                /* Lost the AP a pin led to, the cache may be too old to steer the reconnect away from it */
+                out.actions = PRJ_WIFI_STA_ROAM_ACTION_UNPIN;
+                p_roam->pinned = false;
+            }
+            break;
+
+        case PRJ_WIFI_STA_ROAM_INPUT_RSSI:
+            wifi_sta_roam_rssi(p_roam, p_input, &out);
+            break;
+
+        case PRJ_WIFI_STA_ROAM_INPUT_SCAN_DONE:
+            wifi_sta_roam_scan_done(p_roam, p_input, &out);
+            break;
+
+        default:
+            break;
+    }
+
+    return out;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void wifi_sta_roam_rssi (prj_wifi_sta_roam_t *const p_roam, const prj_wifi_sta_roam_input_t *const p_input,
+                                prj_wifi_sta_roam_output_t *const p_out)
+{
+    const prj_i32_t sample_q4 = (prj_i32_t)p_input->rssi * PRJ_WIFI_STA_ROAM_Q4;
+    const prj_i32_t scan_q4 = (prj_i32_t)p_roam->config.scan_rssi * PRJ_WIFI_STA_ROAM_Q4;
+    const prj_i32_t hyst_q4 = (prj_i32_t)p_roam->config.hysteresis_db * PRJ_WIFI_STA_ROAM_Q4;
+
+    if (!p_roam->associated)
+    {
+        return;
+    }
+
+    /* Single samples swing several dB, only a sustained drop may cost a scan */
+    if (p_roam->rssi_valid)
+    {
+        p_roam->rssi_q4 += (sample_q4 - p_roam->rssi_q4) / PRJ_WIFI_STA_ROAM_EMA_DIV;
+    }
+    else
+    {
+        p_roam->rssi_q4 = sample_q4;
+        p_roam->rssi_valid = true;
+    }
+
+    if (p_roam->rssi_q4 >= (scan_q4 + hyst_q4))
+    {
+        /* Recovered, the next drop scans at the fast rate again */
+        p_roam->scan_period_us = p_roam->config.scan_min_us;
+        p_roam->scan_due_us = (p_roam->scan_due_us < p_input->now_us) ? p_roam->scan_due_us : p_input->now_us;
+    }
+    else if ((p_roam->rssi_q4 < scan_q4) && (p_roam->join == PRJ_WIFI_STA_ROAM_JOIN_NONE) &&
+             (p_input->now_us >= p_roam->scan_due_us))
+    {
+        /* Also holds off the next scan should the result never arrive */
+        p_out->actions = PRJ_WIFI_STA_ROAM_ACTION_SCAN;
+        p_roam->scan_due_us = p_input->now_us + p_roam->scan_period_us;
+    }
+
+    return;
+}
+
+static void wifi_sta_roam_scan_done (prj_wifi_sta_roam_t *const p_roam, const prj_wifi_sta_roam_input_t *const p_input,
+                                     prj_wifi_sta_roam_output_t *const p_out)
+{
+    const prj_i32_t hyst_q4 = (prj_i32_t)p_roam->config.hysteresis_db * PRJ_WIFI_STA_ROAM_Q4;
+    prj_i32_t index = PRJ_WIFI_STA_ROAM_NONE;
+
+    for (prj_size_t i = 0U; i < p_input->count; i++)
+    {
+        wifi_sta_roam_merge(p_roam, &p_input->p_aps[i], p_input->now_us);
+    }
+
+    if (!p_roam->associated || !p_roam->rssi_valid || (p_roam->join != PRJ_WIFI_STA_ROAM_JOIN_NONE))
+    {
+        return;
+    }
+
+    index = wifi_sta_roam_best(p_roam, p_input->now_us, p_roam->bssid);
+
+    if ((index != PRJ_WIFI_STA_ROAM_NONE) &&
+        (((prj_i32_t)p_roam->cache[index].ap.rssi * PRJ_WIFI_STA_ROAM_Q4) >= (p_roam->rssi_q4 + hyst_q4)))
+    {
+        p_out->actions = PRJ_WIFI_STA_ROAM_ACTION_PIN | PRJ_WIFI_STA_ROAM_ACTION_DISCONNECT;
+        p_out->target = p_roam->cache[index].ap;
+        p_roam->target = p_out->target;
+        p_roam->join = PRJ_WIFI_STA_ROAM_JOIN_LEAVING;
+        p_roam->pinned = true;
+        return;
+    }
+
+    /* Nothing better around, back off so a device parked at the edge of coverage stays mostly idle */
+    p_roam->scan_due_us = p_input->now_us + p_roam->scan_period_us;
+    p_roam->scan_period_us = ((p_roam->scan_period_us * 2ULL) < p_roam->config.scan_max_us) ?
+                             (p_roam->scan_period_us * 2U) : p_roam->config.scan_max_us;
+
+    return;
+}
+
+static void wifi_sta_roam_merge (prj_wifi_sta_roam_t *const p_roam, const prj_wifi_sta_roam_ap_t *const p_ap,
+                                 const prj_i64_t now_us)
+{
+    prj_i32_t index = wifi_sta_roam_find(p_roam, p_ap->bssid);
+    prj_wifi_sta_roam_entry_t *p_entry = NULL;
+
+    if ((index == PRJ_WIFI_STA_ROAM_NONE) && (p_roam->count < PRJ_WIFI_STA_ROAM_CACHE_MAX))
+    {
+        index = (prj_i32_t)p_roam->count++;
+        p_roam->cache[index] = (prj_wifi_sta_roam_entry_t){0};
+    }
+    else if (index == PRJ_WIFI_STA_ROAM_NONE)
+    {
+        /* Full: evict a stale entry first, otherwise the weakest if the new AP is stronger */
+        index = 0;
+
+        for (prj_size_t i = 1U; i < p_roam->count; i++)
+        {
+            const prj_bool_t fresh = wifi_sta_roam_fresh(p_roam, &p_roam->cache[i], now_us);
+            const prj_bool_t fresh_min = wifi_sta_roam_fresh(p_roam, &p_roam->cache[index], now_us);
+
+            if ((fresh_min && !fresh) || ((fresh == fresh_min) && (p_roam->cache[i].ap.rssi < p_roam->cache[index].ap.rssi)))
+            {
+                index = (prj_i32_t)i;
+            }
+        }
+
+        if (wifi_sta_roam_fresh(p_roam, &p_roam->cache[index], now_us) && (p_roam->cache[index].ap.rssi >= p_ap->rssi))
+        {
+            return;
+        }
+
+        p_roam->cache[index] = (prj_wifi_sta_roam_entry_t){0};
+    }
+
+    /* A ban outlives the entry refresh, the AP being in range does not mean it lets us in */
+    p_entry = &p_roam->cache[index];
+    p_entry->ap = *p_ap;
+    p_entry->seen_us = now_us;
+
+    return;
+}
+
+static prj_i32_t wifi_sta_roam_find (const prj_wifi_sta_roam_t *const p_roam, const prj_u8_t *const p_bssid)
+{
+    for (prj_size_t i = 0U; i < p_roam->count; i++)
+    {
+        if (memcmp(p_roam->cache[i].ap.bssid, p_bssid, PRJ_WIFI_STA_ROAM_BSSID_LEN) == 0)
+        {
+            return (prj_i32_t)i;
+        }
+    }
+
+    return PRJ_WIFI_STA_ROAM_NONE;
+}
+
+static prj_i32_t wifi_sta_roam_best (const prj_wifi_sta_roam_t *const p_roam, const prj_i64_t now_us,
+                                     const prj_u8_t *const p_exclude)
+{
+    prj_i32_t best = PRJ_WIFI_STA_ROAM_NONE;
+
+    for (prj_size_t i = 0U; i < p_roam->count; i++)
+    {
+        const prj_wifi_sta_roam_entry_t *p_entry = &p_roam->cache[i];
+
+        if (!wifi_sta_roam_fresh(p_roam, p_entry, now_us) || (now_us < p_entry->banned_us) ||
+            ((p_exclude != NULL) && (memcmp(p_entry->ap.bssid, p_exclude, PRJ_WIFI_STA_ROAM_BSSID_LEN) == 0)))
+        {
+            continue;
+        }
+
+        if ((best == PRJ_WIFI_STA_ROAM_NONE) || (p_entry->ap.rssi > p_roam->cache[best].ap.rssi))
+        {
+            best = (prj_i32_t)i;
+        }
+    }
+
+    return best;
+}
+
+static prj_bool_t wifi_sta_roam_fresh (const prj_wifi_sta_roam_t *const p_roam,
+                                       const prj_wifi_sta_roam_entry_t *const p_entry, const prj_i64_t now_us)
+{
+    return ((now_us - p_entry->seen_us) <= (prj_i64_t)p_roam->config.cache_ttl_us);
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
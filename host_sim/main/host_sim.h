@@ -0,0 +1,121 @@
+/**
+ * @file host_sim.h
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "prj_common.h"
+#include "time_sync.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_SIM_TAG         "HOST_SIM"
+#define PRJ_SIM_NTP_SERVERS (3U)
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    prj_u32_t delay_ms; /*!< Round-trip network delay, split evenly between both directions */
+    prj_u32_t loss_pct; /*!< Requests dropped, in percent */
+    prj_bool_t dead;    /*!< Server never answers */
+} prj_sim_ntp_server_t;
+
+typedef struct
+{
+    const prj_char_t *p_name;
+    prj_u32_t assoc_delay_ms;    /*!< AP association time */
+    prj_u32_t dhcp_delay_ms;     /*!< DHCP lease time */
+    prj_u32_t storm;             /*!< Connect attempts failing after the link drop */
+    prj_u32_t ntp_delay_ms;      /*!< NTP round-trip delay of every server */
+    prj_u32_t ntp_loss_pct;      /*!< NTP request loss of every server */
+    prj_u8_t ntp_dead;           /*!< Number of servers that never answer */
+    prj_u32_t connect_budget_ms; /*!< Maximum connect latency */
+    prj_u32_t attempts_budget;   /*!< Maximum connect attempts */
+    prj_u32_t sync_budget_ms;    /*!< Maximum sync latency */
+} prj_sim_scenario_t;
+
+typedef struct
+{
+    prj_i64_t connect_us;   /*!< Start or link drop to link up, -1 if never */
+    prj_u32_t attempts;     /*!< esp_wifi_connect() calls */
+    prj_u32_t failed;       /*!< Failed attempts */
+    prj_status_t sync;      /*!< Sync result */
+    prj_i64_t sync_us;      /*!< Sync latency */
+    prj_u32_t ntp_requests; /*!< Requests seen by the servers, retries included */
+    prj_i64_t offset_us;    /*!< Applied correction */
+    prj_bool_t passed;      /*!< All budgets met */
+} prj_sim_result_t;
+
+typedef struct
+{
+    prj_u32_t cycles;       /*!< Deinit and start cycles that got the link back */
+    prj_i64_t connect_us;   /*!< Slowest reconnect after a restart */
+} prj_sim_restart_t;
+
+typedef struct
+{
+    prj_u32_t now_ns;       /*!< prj_time_now_us() cost per call */
+    prj_u32_t libc_ns;      /*!< gettimeofday() plus localtime_r() cost per call */
+    prj_i64_t deviation_us; /*!< prj_time_now_us() minus the wall clock */
+} prj_sim_stamp_t;
+
+typedef struct
+{
+    prj_u32_t traces;  /*!< Edge traces replayed */
+    prj_u32_t failed;  /*!< Traces whose events differ from the expected ones */
+    prj_u32_t step_ns; /*!< prj_button_fsm_step() cost per call */
+} prj_sim_button_result_t;
+
+typedef struct
+{
+    prj_u32_t phases;    /*!< State change phases played */
+    prj_u32_t failed;    /*!< Phases whose LED steps differ from the pattern */
+    prj_i64_t jitter_us; /*!< Largest LED step timing error */
+} prj_sim_led_result_t;
+
+typedef struct
+{
+    prj_u32_t traces;  /*!< Scan and signal traces replayed */
+    prj_u32_t failed;  /*!< Traces whose roaming actions differ from the expected ones */
+    prj_u32_t step_ns; /*!< prj_wifi_sta_roam_step() cost per RSSI sample */
+} prj_sim_roam_result_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/* Reference clock and the swappable time_sync clock, host_sim_clock.c */
+void prj_sim_clock_init(const prj_i64_t error_us);
+prj_i64_t prj_sim_clock_ref_us(void);
+prj_i64_t prj_sim_clock_error_us(void);
+
+/* Loopback NTP servers, host_sim_ntp.c */
+prj_status_t prj_sim_ntp_start(prj_time_sync_server_t *const p_servers, const prj_u8_t count);
+void prj_sim_ntp_set(const prj_u8_t index, const prj_sim_ntp_server_t *const p_server);
+prj_u32_t prj_sim_ntp_requests_take(void);
+
+/* Scenario runner, host_sim_bench.c */
+prj_status_t prj_sim_bench_init(void);
+void prj_sim_bench_run(const prj_sim_scenario_t *const p_scenario, prj_sim_result_t *const p_result);
+void prj_sim_bench_stamp(prj_sim_stamp_t *const p_stamp);
+void prj_sim_bench_restart(const prj_u32_t cycles, prj_sim_restart_t *const p_restart);
+
+/* Button edge trace replay, host_sim_button.c */
+void prj_sim_button_run(prj_sim_button_result_t *const p_result);
+
+/* Status LED patterns against a fake GPIO, host_sim_led.c */
+void prj_sim_led_run(prj_sim_led_result_t *const p_result);
+
+/* Roaming decisions against scripted scan results, host_sim_roam.c */
+void prj_sim_roam_run(prj_sim_roam_result_t *const p_result);
+#endif /* HOST_SIM_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,260 @@
+/**
+ * @file host_sim_bench.c
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "host_sim.h"
+#include "wifi_sta.h"
+#include "prj_sim_wifi.h"
+#include "prj_sim_sntp.h"
+#include "prj_prof.h"
+
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include "esp_netif.h"
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_SIM_BENCH_CONNECT_TOUT_MS (60000U)
+#define PRJ_SIM_BENCH_STAMP_CALLS     (1000000U)
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void prj_sim_bench_wifi_cb(const prj_wifi_sta_event_t event, void *const p_ctx);
+static prj_status_t prj_sim_bench_sync(const prj_sim_scenario_t *const p_scenario, prj_time_sync_result_t *const p_sync,
+                                       prj_u32_t *const p_requests);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static SemaphoreHandle_t m_link_up = NULL;
+static prj_bool_t m_started = false;
+#if CONFIG_SNTP_MULTI_SERVER
+static prj_time_sync_server_t m_servers[PRJ_SIM_NTP_SERVERS] = {0};
+#endif
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+prj_status_t prj_sim_bench_init(void)
+{
+    /* Preconditions of prj_wifi_sta_start(), run by the startup table on the target */
+    if ((esp_netif_init() != ESP_OK) || (esp_event_loop_create_default() != ESP_OK))
+    {
+        return PRJ_ERROR_RESOURCES;
+    }
+
+    m_link_up = xSemaphoreCreateBinary();
+
+    if (m_link_up == NULL)
+    {
+        return PRJ_ERROR_RESOURCES;
+    }
+
+#if CONFIG_SNTP_MULTI_SERVER
+    if (prj_sim_ntp_start(m_servers, PRJ_SIM_NTP_SERVERS) != PRJ_SUCCESS)
+    {
+        return PRJ_ERROR_RESOURCES;
+    }
+#endif
+
+    return prj_wifi_sta_cb_register(prj_sim_bench_wifi_cb, NULL);
+}
+
+void prj_sim_bench_run(const prj_sim_scenario_t *const p_scenario, prj_sim_result_t *const p_result)
+{
+    const prj_sim_wifi_ap_t ap = {
+        .assoc_delay_ms = p_scenario->assoc_delay_ms,
+        .dhcp_delay_ms  = p_scenario->dhcp_delay_ms,
+        .fail_count     = p_scenario->storm,
+        .bssid          = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01},
+        .channel        = 6U,
+        .ip             = ESP_IP4TOADDR(192, 168, 4, 2),
+        .rssi           = -55,
+    };
+    prj_sim_wifi_stats_t stats = {0};
+    prj_time_sync_result_t sync = {0};
+    prj_i64_t start_us = 0;
+
+    memset(p_result, 0, sizeof(*p_result));
+    p_result->connect_us = -1;
+    p_result->sync_us = -1;
+
+    xSemaphoreTake(m_link_up, 0);
+    prj_sim_wifi_stats_take(&stats);
+    prj_sim_wifi_ap_set(&ap);
+
+    /* The first scenario measures the cold start, the others the recovery from a dropped link */
+    start_us = esp_timer_get_time();
+
+    if (!m_started)
+    {
+        m_started = (prj_wifi_sta_start(NULL) == PRJ_SUCCESS);
+    }
+    else
+    {
+        prj_sim_wifi_link_drop(p_scenario->storm);
+    }
+
+    if (xSemaphoreTake(m_link_up, pdMS_TO_TICKS(PRJ_SIM_BENCH_CONNECT_TOUT_MS)) == pdTRUE)
+    {
+        p_result->connect_us = esp_timer_get_time() - start_us;
+    }
+
+    prj_sim_wifi_stats_take(&stats);
+    p_result->attempts = stats.connect_calls;
+    p_result->failed = stats.failed;
+
+    if (p_result->connect_us >= 0)
+    {
+        start_us = esp_timer_get_time();
+        p_result->sync = prj_sim_bench_sync(p_scenario, &sync, &p_result->ntp_requests);
+        p_result->sync_us = esp_timer_get_time() - start_us;
+        p_result->offset_us = sync.offset_us;
+    }
+    else
+    {
+        p_result->sync = PRJ_ERROR_INVALID_STATE;
+    }
+
+    p_result->passed = (p_result->connect_us >= 0) &&
+                       (p_result->connect_us <= ((prj_i64_t)p_scenario->connect_budget_ms * 1000LL)) &&
+                       (p_result->attempts <= p_scenario->attempts_budget) &&
+                       (p_result->sync == PRJ_SUCCESS) &&
+                       (p_result->sync_us <= ((prj_i64_t)p_scenario->sync_budget_ms * 1000LL));
+
+    return;
+}
+void prj_sim_bench_stamp(prj_sim_stamp_t *const p_stamp)
+{
+    volatile prj_i64_t sink = 0;
+    struct timeval tv = {0};
+    struct tm time_info = {0};
+    time_t time_now = 0;
+    prj_i64_t start_us = 0;
+
+    start_us = esp_timer_get_time();
+
+    for (prj_u32_t i = 0U; i < PRJ_SIM_BENCH_STAMP_CALLS; i++)
+    {
+        sink = prj_time_now_us();
+    }
+
+    p_stamp->now_ns = (prj_u32_t)(((esp_timer_get_time() - start_us) * 1000LL) / PRJ_SIM_BENCH_STAMP_CALLS);
+
+    /* The path callers used before: wall clock read and broken-down time */
+    start_us = esp_timer_get_time();
+
+    for (prj_u32_t i = 0U; i < PRJ_SIM_BENCH_STAMP_CALLS; i++)
+    {
+        gettimeofday(&tv, NULL);
+        time_now = tv.tv_sec;
+        localtime_r(&time_now, &time_info);
+        sink = tv.tv_usec;
+    }
+
+    p_stamp->libc_ns = (prj_u32_t)(((esp_timer_get_time() - start_us) * 1000LL) / PRJ_SIM_BENCH_STAMP_CALLS);
+    p_stamp->deviation_us = prj_time_now_us() - (prj_sim_clock_error_us() + prj_sim_clock_ref_us());
+    (void)sink;
+
+    return;
+}
+
+void prj_sim_bench_restart(const prj_u32_t cycles, prj_sim_restart_t *const p_restart)
+{
+    prj_i64_t start_us = 0;
+    prj_i64_t connect_us = 0;
+
+    memset(p_restart, 0, sizeof(*p_restart));
+    prj_time_sync_background_start();
+
+    /* The stubs have fixed timer and handler pools, so anything a deinit leaves behind runs them dry */
+    for (prj_u32_t i = 0U; i < cycles; i++)
+    {
+        if ((prj_time_sync_deinit() != PRJ_SUCCESS) || (prj_wifi_sta_deinit() != PRJ_SUCCESS))
+        {
+            break;
+        }
+
+        xSemaphoreTake(m_link_up, 0);
+        start_us = esp_timer_get_time();
+
+        if ((prj_wifi_sta_start(NULL) != PRJ_SUCCESS) ||
+            (xSemaphoreTake(m_link_up, pdMS_TO_TICKS(PRJ_SIM_BENCH_CONNECT_TOUT_MS)) != pdTRUE) ||
+            (prj_time_sync_background_start() != PRJ_SUCCESS))
+        {
+            break;
+        }
+
+        connect_us = esp_timer_get_time() - start_us;
+        p_restart->connect_us = (connect_us > p_restart->connect_us) ? connect_us : p_restart->connect_us;
+        p_restart->cycles++;
+    }
+
+    return;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void prj_sim_bench_wifi_cb(const prj_wifi_sta_event_t event, void *const p_ctx)
+{
+    if (event == PRJ_WIFI_STA_EVENT_LINK_UP)
+    {
+        xSemaphoreGive(m_link_up);
+    }
+
+    return;
+}
+
+static prj_status_t prj_sim_bench_sync(const prj_sim_scenario_t *const p_scenario, prj_time_sync_result_t *const p_sync,
+                                       prj_u32_t *const p_requests)
+{
+    prj_status_t status = PRJ_SUCCESS;
+
+#if CONFIG_SNTP_MULTI_SERVER
+    prj_sim_ntp_server_t server = {0};
+
+    /* The first ntp_dead servers never answer */
+    for (prj_u8_t i = 0U; i < PRJ_SIM_NTP_SERVERS; i++)
+    {
+        server.delay_ms = p_scenario->ntp_delay_ms;
+        server.loss_pct = p_scenario->ntp_loss_pct;
+        server.dead = (i < p_scenario->ntp_dead);
+        prj_sim_ntp_set(i, &server);
+    }
+
+    /* prj_time_sync_wait() brackets the engine with these phases, the benchmark calls it directly */
+    prj_sim_ntp_requests_take();
+    prj_prof_begin(PRJ_PROF_PHASE_SNTP_REQ);
+    status = prj_time_sync_ntp_run(m_servers, PRJ_SIM_NTP_SERVERS, CONFIG_SNTP_TIME_SYNC_TOUT_MS, p_sync);
+    prj_prof_end(PRJ_PROF_PHASE_SNTP_SET);
+    *p_requests = prj_sim_ntp_requests_take();
+#else
+    /* The lwIP client talks to one server, loss is not modelled */
+    const prj_sim_sntp_t sntp = {
+        .reply_delay_ms = p_scenario->ntp_delay_ms,
+        .lost           = (p_scenario->ntp_dead > 0U),
+        .p_server_us    = prj_sim_clock_ref_us,
+    };
+
+    prj_sim_sntp_set(&sntp);
+    prj_sim_sntp_requests_take();
+    status = prj_time_sync_wait(CONFIG_SNTP_TIME_SYNC_TOUT_MS, p_sync);
+    *p_requests = prj_sim_sntp_requests_take();
+#endif
+
+    return status;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
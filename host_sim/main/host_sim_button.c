@@ -0,0 +1,187 @@
+/**
+ * @file host_sim_button.c
+ * @date 05/30/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "host_sim.h"
+#include "prj_button_fsm.h"
+
+#include <string.h>
+#include <time.h>
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_SIM_BUTTON_EDGE_MAX   (16U)
+#define PRJ_SIM_BUTTON_EVENT_MAX  (16U)
+#define PRJ_SIM_BUTTON_STEP_CALLS (1000000U)
+
+/* Fixed timing so the expected sequences do not follow the Kconfig defaults */
+#define PRJ_SIM_BUTTON_DEBOUNCE_US (20000U)
+#define PRJ_SIM_BUTTON_LONG_US     (1000000U)
+#define PRJ_SIM_BUTTON_DOUBLE_US   (300000U)
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    prj_i64_t time_us;  /*!< Edge timestamp as the ISR would take it */
+    prj_bool_t pressed; /*!< Level after the edge */
+} prj_sim_button_edge_t;
+
+typedef struct
+{
+    const prj_char_t *p_name;
+    const prj_char_t *p_expected; /*!< P press, R release, D double click, L long press */
+    prj_sim_button_edge_t edges[PRJ_SIM_BUTTON_EDGE_MAX];
+    prj_size_t count;
+} prj_sim_button_trace_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static prj_bool_t prj_sim_button_replay(const prj_sim_button_trace_t *const p_trace, prj_char_t *const p_events);
+static void prj_sim_button_append(const prj_u32_t events, prj_char_t *const p_events);
+static prj_u32_t prj_sim_button_step_ns(void);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static const prj_button_fsm_config_t m_config = {
+    .debounce_us = PRJ_SIM_BUTTON_DEBOUNCE_US,
+    .long_us     = PRJ_SIM_BUTTON_LONG_US,
+    .double_us   = PRJ_SIM_BUTTON_DOUBLE_US,
+};
+
+static const prj_sim_button_trace_t m_traces[] = {
+    /* Contact bounce on both edges, each edge reported once */
+    {"click_bouncy", "PR",
+     {{0, true}, {300, false}, {600, true}, {1000, false}, {1500, true},
+      {100000, false}, {100200, true}, {100500, false}}, 8U},
+    /* Spike shorter than the debounce window, the release is found when the window ends */
+    {"spike", "PR", {{0, true}, {200, false}}, 2U},
+    {"long_press", "PLR", {{0, true}, {1500000, false}}, 2U},
+    {"double_click", "PRPDR", {{0, true}, {100000, false}, {250000, true}, {350000, false}}, 4U},
+    {"slow_double", "PRPR", {{0, true}, {100000, false}, {500000, true}, {600000, false}}, 4U},
+    /* The second click is spent on the double click, the third starts afresh */
+    {"triple_click", "PRPDRPR",
+     {{0, true}, {100000, false}, {200000, true}, {300000, false}, {400000, true}, {500000, false}}, 6U},
+    /* A long press release does not arm a double click */
+    {"long_then_click", "PLRPR", {{0, true}, {1500000, false}, {1600000, true}, {1700000, false}}, 4U},
+};
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void prj_sim_button_run(prj_sim_button_result_t *const p_result)
+{
+    prj_char_t events[PRJ_SIM_BUTTON_EVENT_MAX + 1U] = {0};
+    prj_bool_t passed = false;
+
+    memset(p_result, 0, sizeof(*p_result));
+
+    for (prj_size_t i = 0U; i < (sizeof(m_traces) / sizeof(m_traces[0])); i++)
+    {
+        passed = prj_sim_button_replay(&m_traces[i], events);
+        p_result->traces++;
+        p_result->failed += passed ? 0U : 1U;
+
+        ESP_LOGI(PRJ_SIM_TAG, "bench: button %-16s events=%-8s expected=%-8s %s", m_traces[i].p_name, events,
+                 m_traces[i].p_expected, passed ? "PASS" : "FAIL");
+    }
+
+    p_result->step_ns = prj_sim_button_step_ns();
+
+    return;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static prj_bool_t prj_sim_button_replay(const prj_sim_button_trace_t *const p_trace, prj_char_t *const p_events)
+{
+    prj_button_fsm_t fsm = {0};
+    prj_button_fsm_output_t out = {0};
+    prj_bool_t level = false;
+
+    p_events[0] = '\0';
+    prj_button_fsm_init(&fsm, &m_config);
+
+    for (prj_size_t i = 0U; i <= p_trace->count; i++)
+    {
+        /* Timers due before the next edge fire first and sample the level left by the previous one */
+        while ((out.deadline_us != 0) && ((i == p_trace->count) || (out.deadline_us <= p_trace->edges[i].time_us)))
+        {
+            out = prj_button_fsm_step(&fsm, PRJ_BUTTON_FSM_INPUT_TIMER, level, out.deadline_us);
+            prj_sim_button_append(out.events, p_events);
+        }
+
+        if (i < p_trace->count)
+        {
+            level = p_trace->edges[i].pressed;
+            out = prj_button_fsm_step(&fsm, PRJ_BUTTON_FSM_INPUT_EDGE, level, p_trace->edges[i].time_us);
+            prj_sim_button_append(out.events, p_events);
+        }
+    }
+
+    return (strcmp(p_events, p_trace->p_expected) == 0);
+}
+
+static void prj_sim_button_append(const prj_u32_t events, prj_char_t *const p_events)
+{
+    /* Same order the driver queues them in */
+    static const struct
+    {
+        prj_u32_t flag;
+        prj_char_t code;
+    } map[] = {
+        {PRJ_BUTTON_FSM_EVENT_RELEASE, 'R'},
+        {PRJ_BUTTON_FSM_EVENT_PRESS, 'P'},
+        {PRJ_BUTTON_FSM_EVENT_DOUBLE_CLICK, 'D'},
+        {PRJ_BUTTON_FSM_EVENT_LONG_PRESS, 'L'},
+    };
+    prj_size_t len = strlen(p_events);
+
+    for (prj_size_t i = 0U; (i < (sizeof(map) / sizeof(map[0]))) && (len < PRJ_SIM_BUTTON_EVENT_MAX); i++)
+    {
+        if ((events & map[i].flag) != 0U)
+        {
+            p_events[len++] = map[i].code;
+        }
+    }
+
+    p_events[len] = '\0';
+
+    return;
+}
+
+static prj_u32_t prj_sim_button_step_ns(void)
+{
+    prj_button_fsm_t fsm = {0};
+    struct timespec start = {0};
+    struct timespec end = {0};
+    volatile prj_u32_t sink = 0U;
+
+    prj_button_fsm_init(&fsm, &m_config);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* Alternate accepted edges and lockout ends, the work the ISR and the timer do per edge */
+    for (prj_u32_t i = 0U; i < PRJ_SIM_BUTTON_STEP_CALLS; i++)
+    {
+        const prj_i64_t now_us = (prj_i64_t)i * PRJ_SIM_BUTTON_DEBOUNCE_US;
+        const prj_button_fsm_input_t input = ((i & 1U) == 0U) ? PRJ_BUTTON_FSM_INPUT_EDGE : PRJ_BUTTON_FSM_INPUT_TIMER;
+
+        sink += prj_button_fsm_step(&fsm, input, (i & 2U) == 0U, now_us).events;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    (void)sink;
+
+    return (prj_u32_t)((((prj_i64_t)(end.tv_sec - start.tv_sec) * 1000000000LL) + (end.tv_nsec - start.tv_nsec)) /
+                       PRJ_SIM_BUTTON_STEP_CALLS);
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
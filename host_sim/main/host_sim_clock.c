@@ -0,0 +1,94 @@
+/**
+ * @file host_sim_clock.c
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "host_sim.h"
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_SIM_CLOCK_EPOCH_US (1748217600LL * 1000000LL) /* 2025-05-26 00:00:00 UTC */
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static prj_i64_t prj_sim_clock_wall_us(void);
+static void prj_sim_clock_wall_set_us(const prj_i64_t wall_us);
+static void prj_sim_clock_wall_slew_us(const prj_i64_t delta_us);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+static prj_i64_t m_wall_base_us = 0;
+
+/* The host clock is never touched, time_sync steps and slews this one */
+static const prj_time_sync_clock_t m_clock = {
+    .rtc_us       = esp_timer_get_time,
+    .wall_us      = prj_sim_clock_wall_us,
+    .wall_set_us  = prj_sim_clock_wall_set_us,
+    .wall_slew_us = prj_sim_clock_wall_slew_us,
+};
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void prj_sim_clock_init(const prj_i64_t error_us)
+{
+    m_wall_base_us = PRJ_SIM_CLOCK_EPOCH_US + error_us;
+    prj_time_sync_clock_set(&m_clock);
+
+    return;
+}
+
+prj_i64_t prj_sim_clock_ref_us(void)
+{
+    return PRJ_SIM_CLOCK_EPOCH_US + esp_timer_get_time();
+}
+
+prj_i64_t prj_sim_clock_error_us(void)
+{
+    return prj_sim_clock_wall_us() - prj_sim_clock_ref_us();
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static prj_i64_t prj_sim_clock_wall_us(void)
+{
+    prj_i64_t base_us = 0;
+
+    portENTER_CRITICAL(&m_lock);
+    base_us = m_wall_base_us;
+    portEXIT_CRITICAL(&m_lock);
+
+    return base_us + esp_timer_get_time();
+}
+
+static void prj_sim_clock_wall_set_us(const prj_i64_t wall_us)
+{
+    portENTER_CRITICAL(&m_lock);
+    m_wall_base_us = wall_us - esp_timer_get_time();
+    portEXIT_CRITICAL(&m_lock);
+
+    return;
+}
+
+static void prj_sim_clock_wall_slew_us(const prj_i64_t delta_us)
+{
+    /* Applied at once, the benchmark only looks at the end result */
+    portENTER_CRITICAL(&m_lock);
+    m_wall_base_us += delta_us;
+    portEXIT_CRITICAL(&m_lock);
+
+    return;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
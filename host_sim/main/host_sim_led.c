@@ -0,0 +1,190 @@
+/**
+ * @file host_sim_led.c
+ * @date 06/02/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "host_sim.h"
+#include "prj_led.h"
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_SIM_LED_CALL_MAX    (64U)
+#define PRJ_SIM_LED_TOLERANCE   (20000LL) /* Host scheduling jitter allowed per LED step, microseconds */
+#define PRJ_SIM_LED_STATE_NONE  (PRJ_LED_STATE_MAX)
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    prj_i64_t time_us;
+    prj_bool_t on;
+} prj_sim_led_call_t;
+
+typedef struct
+{
+    const prj_char_t *p_name;
+    prj_led_state_t set;    /*!< State activated first, PRJ_SIM_LED_STATE_NONE for none */
+    prj_led_state_t clear;  /*!< State cleared afterwards, PRJ_SIM_LED_STATE_NONE for none */
+    prj_led_state_t shown;  /*!< State whose pattern must play, PRJ_SIM_LED_STATE_NONE for off */
+    prj_u32_t window_ms;    /*!< Time the fake GPIO is recorded for */
+} prj_sim_led_phase_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void prj_sim_led_level_set(const prj_bool_t on);
+static prj_bool_t prj_sim_led_phase(const prj_sim_led_phase_t *const p_phase, prj_i64_t *const p_jitter_us);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static const prj_led_output_t m_output = {
+    .level_set = prj_sim_led_level_set,
+};
+
+/* Run in order, each phase starts from the states the previous one left */
+static const prj_sim_led_phase_t m_phases[] = {
+    /* name                set                            clear                          shown                          window */
+    {"connecting",         PRJ_LED_STATE_CONNECTING,      PRJ_SIM_LED_STATE_NONE,        PRJ_LED_STATE_CONNECTING,       650U},
+    {"sync_failed",        PRJ_LED_STATE_SYNC_FAILED,     PRJ_SIM_LED_STATE_NONE,        PRJ_LED_STATE_SYNC_FAILED,      700U},
+    {"sync_recovered",     PRJ_SIM_LED_STATE_NONE,        PRJ_LED_STATE_SYNC_FAILED,     PRJ_LED_STATE_CONNECTING,       450U},
+    {"connected",          PRJ_LED_STATE_CONNECTED,       PRJ_LED_STATE_CONNECTING,      PRJ_LED_STATE_CONNECTED,        300U},
+    {"off",                PRJ_SIM_LED_STATE_NONE,        PRJ_LED_STATE_CONNECTED,       PRJ_SIM_LED_STATE_NONE,         300U},
+};
+
+static portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+static prj_sim_led_call_t m_calls[PRJ_SIM_LED_CALL_MAX];
+static prj_u32_t m_call_count = 0U;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void prj_sim_led_run(prj_sim_led_result_t *const p_result)
+{
+    prj_i64_t jitter_us = 0;
+    prj_bool_t passed = false;
+
+    *p_result = (prj_sim_led_result_t){0};
+
+    prj_led_output_set(&m_output);
+
+    if (prj_led_init() != PRJ_SUCCESS)
+    {
+        p_result->failed++;
+        return;
+    }
+
+    for (prj_size_t i = 0U; i < (sizeof(m_phases) / sizeof(m_phases[0])); i++)
+    {
+        passed = prj_sim_led_phase(&m_phases[i], &jitter_us);
+        p_result->phases++;
+        p_result->failed += passed ? 0U : 1U;
+        p_result->jitter_us = (jitter_us > p_result->jitter_us) ? jitter_us : p_result->jitter_us;
+
+        ESP_LOGI(PRJ_SIM_TAG, "bench: led %-16s steps=%" PRIu32 " jitter_us=%" PRId64 " %s", m_phases[i].p_name,
+                 m_call_count, jitter_us, passed ? "PASS" : "FAIL");
+    }
+
+    p_result->failed += (prj_led_deinit() == PRJ_SUCCESS) ? 0U : 1U;
+    prj_led_output_set(NULL);
+
+    return;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void prj_sim_led_level_set(const prj_bool_t on)
+{
+    const prj_i64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&m_lock);
+
+    if (m_call_count < PRJ_SIM_LED_CALL_MAX)
+    {
+        m_calls[m_call_count].time_us = now_us;
+        m_calls[m_call_count].on = on;
+        m_call_count++;
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    return;
+}
+
+static prj_bool_t prj_sim_led_phase(const prj_sim_led_phase_t *const p_phase, prj_i64_t *const p_jitter_us)
+{
+    prj_led_seq_t seq = {0};
+    prj_led_seq_step_t step = {0};
+    prj_i64_t start_us = 0;
+    prj_i64_t step_us = 0;
+    prj_i64_t end_us = 0;
+    prj_i64_t error_us = 0;
+    prj_bool_t passed = true;
+
+    portENTER_CRITICAL(&m_lock);
+    m_call_count = 0U;
+    portEXIT_CRITICAL(&m_lock);
+
+    *p_jitter_us = 0;
+    start_us = esp_timer_get_time();
+
+    if (p_phase->set != PRJ_SIM_LED_STATE_NONE)
+    {
+        prj_led_state_set(p_phase->set, true);
+    }
+
+    if (p_phase->clear != PRJ_SIM_LED_STATE_NONE)
+    {
+        prj_led_state_set(p_phase->clear, false);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(p_phase->window_ms));
+    end_us = start_us + ((prj_i64_t)p_phase->window_ms * 1000LL) - PRJ_SIM_LED_TOLERANCE;
+
+    /* Replay the pattern with the sequencer and match every step due well inside the window */
+    prj_led_seq_start(&seq, (p_phase->shown != PRJ_SIM_LED_STATE_NONE) ? prj_led_pattern_get(p_phase->shown) : NULL);
+    step_us = start_us;
+
+    portENTER_CRITICAL(&m_lock);
+
+    for (prj_u32_t i = 0U; step_us < end_us; i++)
+    {
+        step = prj_led_seq_next(&seq);
+
+        if ((i >= m_call_count) || (m_calls[i].on != step.on))
+        {
+            passed = false;
+            break;
+        }
+
+        error_us = llabs((long long)(m_calls[i].time_us - step_us));
+        *p_jitter_us = (error_us > *p_jitter_us) ? error_us : *p_jitter_us;
+        passed = passed && (error_us <= PRJ_SIM_LED_TOLERANCE);
+
+        if (step.hold_ms == 0U)
+        {
+            /* A held level must not be written again */
+            passed = passed && (m_call_count == (i + 1U));
+            break;
+        }
+
+        step_us += (prj_i64_t)step.hold_ms * 1000LL;
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    return passed;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
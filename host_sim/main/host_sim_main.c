@@ -0,0 +1,143 @@
+/**
+ * @file host_sim_main.c
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "host_sim.h"
+#include "prj_log.h"
+#include "prj_metrics.h"
+#include "prj_prof.h"
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_SIM_CLOCK_ERROR_US (2000000LL) /* Unsynced clock at boot, the first sync steps it */
+#define PRJ_SIM_LOG_FLUSH_MS   (200U)
+#define PRJ_SIM_RESTART_CYCLES (20U)
+#define PRJ_SIM_METRICS_JSON   (1024U)
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static prj_bool_t prj_sim_metrics_check(void);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+/* Budgets assume the backoff and quorum set in host_sim/sdkconfig.defaults */
+static const prj_sim_scenario_t m_scenarios[] = {
+    /* name                 assoc  dhcp  storm  ntp  loss  dead  connect  attempts  sync */
+    {"cold_start",            50U,  20U,    0U,  10U,   0U,   0U,    500U,       1U,  500U},
+    {"slow_assoc",          1500U, 800U,    0U,  10U,   0U,   0U,   3000U,       2U,  500U},
+    {"disconnect_storm",      50U,  20U,    6U,  10U,   0U,   0U,   9000U,       7U,  500U},
+    {"ntp_slow",              50U,  20U,    0U, 300U,   0U,   0U,    500U,       1U, 2500U},
+    {"ntp_lossy",             50U,  20U,    0U,  10U,  40U,   0U,    500U,       1U, 6000U},
+    {"ntp_server_dead",       50U,  20U,    0U,  10U,   0U,   1U,    500U,       1U,  500U},
+};
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void app_main(void)
+{
+    prj_sim_result_t result = {0};
+    prj_sim_stamp_t stamp = {0};
+    prj_sim_restart_t restart = {0};
+    prj_sim_button_result_t button = {0};
+    prj_sim_led_result_t led = {0};
+    prj_sim_roam_result_t roam = {0};
+    prj_u32_t failed = 0U;
+    prj_bool_t passed = false;
+
+    prj_log_init();
+    prj_sim_clock_init(PRJ_SIM_CLOCK_ERROR_US);
+
+    if (prj_sim_bench_init() != PRJ_SUCCESS)
+    {
+        ESP_LOGE(PRJ_SIM_TAG, "host sim: init failed");
+        exit(EXIT_FAILURE);
+    }
+
+    for (prj_size_t i = 0U; i < (sizeof(m_scenarios) / sizeof(m_scenarios[0])); i++)
+    {
+        prj_sim_bench_run(&m_scenarios[i], &result);
+        failed += result.passed ? 0U : 1U;
+
+        ESP_LOGI(PRJ_SIM_TAG, "bench: %-18s connect_ms=%" PRId64 " attempts=%" PRIu32 " failed=%" PRIu32
+                 " sync_ms=%" PRId64 " ntp_requests=%" PRIu32 " offset_us=%" PRId64 " clock_error_us=%" PRId64 " %s",
+                 m_scenarios[i].p_name, (result.connect_us >= 0) ? (result.connect_us / 1000) : -1, result.attempts,
+                 result.failed, (result.sync_us >= 0) ? (result.sync_us / 1000) : -1, result.ntp_requests,
+                 result.offset_us, prj_sim_clock_error_us(), result.passed ? "PASS" : "FAIL");
+    }
+
+    prj_sim_bench_stamp(&stamp);
+    ESP_LOGI(PRJ_SIM_TAG, "bench: timestamp now_ns=%" PRIu32 " libc_ns=%" PRIu32 " deviation_us=%" PRId64,
+             stamp.now_ns, stamp.libc_ns, stamp.deviation_us);
+
+    prj_sim_bench_restart(PRJ_SIM_RESTART_CYCLES, &restart);
+    failed += (restart.cycles == PRJ_SIM_RESTART_CYCLES) ? 0U : 1U;
+    ESP_LOGI(PRJ_SIM_TAG, "bench: restart cycles=%" PRIu32 " connect_ms_max=%" PRId64 " %s",
+             restart.cycles, restart.connect_us / 1000,
+             (restart.cycles == PRJ_SIM_RESTART_CYCLES) ? "PASS" : "FAIL");
+
+    prj_sim_button_run(&button);
+    failed += button.failed;
+    ESP_LOGI(PRJ_SIM_TAG, "bench: button traces=%" PRIu32 " failed=%" PRIu32 " step_ns=%" PRIu32,
+             button.traces, button.failed, button.step_ns);
+
+    prj_sim_led_run(&led);
+    failed += led.failed;
+    ESP_LOGI(PRJ_SIM_TAG, "bench: led phases=%" PRIu32 " failed=%" PRIu32 " jitter_us=%" PRId64,
+             led.phases, led.failed, led.jitter_us);
+
+    prj_sim_roam_run(&roam);
+    failed += roam.failed;
+    ESP_LOGI(PRJ_SIM_TAG, "bench: roam traces=%" PRIu32 " failed=%" PRIu32 " step_ns=%" PRIu32,
+             roam.traces, roam.failed, roam.step_ns);
+
+    passed = prj_sim_metrics_check();
+    failed += passed ? 0U : 1U;
+    ESP_LOGI(PRJ_SIM_TAG, "bench: metrics %s", passed ? "PASS" : "FAIL");
+
+    prj_prof_summary_print();
+
+    /* Let the deferred log catch up before leaving */
+    vTaskDelay(pdMS_TO_TICKS(PRJ_SIM_LOG_FLUSH_MS));
+    ESP_LOGI(PRJ_SIM_TAG, "bench: %" PRIu32 " of %" PRIu32 " scenarios failed", failed,
+             (prj_u32_t)(sizeof(m_scenarios) / sizeof(m_scenarios[0])) + 2U + button.traces + led.phases + roam.traces);
+
+    exit((failed == 0U) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static prj_bool_t prj_sim_metrics_check(void)
+{
+    static prj_char_t json[PRJ_SIM_METRICS_JSON];
+    const prj_i32_t len = prj_metrics_snapshot_json(json, sizeof(json));
+    const prj_i32_t bin_size = prj_metrics_snapshot_bin(NULL, 0U);
+
+    ESP_LOGI(PRJ_SIM_TAG, "bench: metrics %s", json);
+
+    /*
+     * The scenarios above connected and went through the disconnect storm, the station counters must have
+     * seen it. The bench drives the NTP engine without prj_time_sync_wait(), so the sync metrics are not checked.
+     */
+    return (len < (prj_i32_t)sizeof(json)) &&
+           (bin_size == (prj_i32_t)(PRJ_METRICS_BIN_HEADER_SIZE + (PRJ_METRICS_MAX * sizeof(prj_i32_t)))) &&
+           (prj_metrics_get(PRJ_METRICS_WIFI_STA_CONNECTS) > 0) &&
+           (prj_metrics_get(PRJ_METRICS_WIFI_STA_DISCONNECTS) > 0) &&
+           (prj_metrics_get(PRJ_METRICS_WIFI_STA_RETRIES) > 0) &&
+           (prj_metrics_get(PRJ_METRICS_WIFI_STA_RSSI) < 0);
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
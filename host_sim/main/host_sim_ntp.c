@@ -0,0 +1,264 @@
+/**
+ * @file host_sim_ntp.c
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "host_sim.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_SIM_NTP_HOST          "127.0.0.1"
+#define PRJ_SIM_NTP_PACKET_SIZE   (48U)
+#define PRJ_SIM_NTP_PENDING_MAX   (32U)
+#define PRJ_SIM_NTP_POLL_MS       (2)
+#define PRJ_SIM_NTP_UNIX_OFFSET   (2208988800LL) /* Seconds from 1900 to 1970 */
+#define PRJ_SIM_NTP_MODE_SERVER   (0x24U)        /* LI 0, VN 4, mode 4 */
+#define PRJ_SIM_NTP_STRATUM       (1U)
+#define PRJ_SIM_NTP_OFF_ORIGIN    (24U)
+#define PRJ_SIM_NTP_OFF_RECEIVE   (32U)
+#define PRJ_SIM_NTP_OFF_TRANSMIT  (40U)
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    prj_u8_t packet[PRJ_SIM_NTP_PACKET_SIZE];
+    struct sockaddr_in addr;
+    prj_i64_t due_us;
+    prj_u8_t server;
+    prj_bool_t used;
+} prj_sim_ntp_pending_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void *prj_sim_ntp_thread(void *p_arg);
+static void prj_sim_ntp_receive(const prj_u8_t server, const prj_i64_t now_us);
+static void prj_sim_ntp_ts_write(prj_u8_t *const p_buf, const prj_i64_t unix_us);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+/* Shared with a plain pthread, FreeRTOS critical sections do not apply */
+static pthread_mutex_t m_lock = PTHREAD_MUTEX_INITIALIZER;
+static prj_sim_ntp_server_t m_servers[PRJ_SIM_NTP_SERVERS];
+static prj_sim_ntp_pending_t m_pending[PRJ_SIM_NTP_PENDING_MAX];
+static int m_fds[PRJ_SIM_NTP_SERVERS] = {-1, -1, -1};
+static prj_u8_t m_count = 0U;
+static prj_u32_t m_requests = 0U;
+static unsigned int m_seed = 1U;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+prj_status_t prj_sim_ntp_start(prj_time_sync_server_t *const p_servers, const prj_u8_t count)
+{
+    struct sockaddr_in addr = {0};
+    socklen_t len = sizeof(addr);
+    pthread_t thread = {0};
+    sigset_t all = {0};
+    sigset_t old = {0};
+    int err = 0;
+
+    if ((p_servers == NULL) || (count == 0U) || (count > PRJ_SIM_NTP_SERVERS))
+    {
+        return PRJ_ERROR_INVALID_PARAM;
+    }
+
+    for (prj_u8_t i = 0U; i < count; i++)
+    {
+        addr.sin_family = AF_INET;
+        addr.sin_port = 0U;
+        addr.sin_addr.s_addr = inet_addr(PRJ_SIM_NTP_HOST);
+        len = sizeof(addr);
+
+        m_fds[i] = socket(AF_INET, SOCK_DGRAM, 0);
+
+        if ((m_fds[i] < 0) ||
+            (bind(m_fds[i], (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+            (getsockname(m_fds[i], (struct sockaddr *)&addr, &len) != 0))
+        {
+            ESP_LOGE(PRJ_SIM_TAG, "sim ntp start: failed to open server %u", i);
+            return PRJ_ERROR_RESOURCES;
+        }
+
+        p_servers[i].p_host = PRJ_SIM_NTP_HOST;
+        p_servers[i].port = ntohs(addr.sin_port);
+    }
+
+    m_count = count;
+
+    /* Plain thread outside the scheduler, keep the FreeRTOS port signals away from it */
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    err = pthread_create(&thread, NULL, prj_sim_ntp_thread, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (err != 0)
+    {
+        ESP_LOGE(PRJ_SIM_TAG, "sim ntp start: failed to create thread");
+        return PRJ_ERROR_RESOURCES;
+    }
+
+    pthread_detach(thread);
+
+    return PRJ_SUCCESS;
+}
+
+void prj_sim_ntp_set(const prj_u8_t index, const prj_sim_ntp_server_t *const p_server)
+{
+    if (index >= PRJ_SIM_NTP_SERVERS)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&m_lock);
+    m_servers[index] = *p_server;
+    pthread_mutex_unlock(&m_lock);
+
+    return;
+}
+
+prj_u32_t prj_sim_ntp_requests_take(void)
+{
+    prj_u32_t requests = 0U;
+
+    pthread_mutex_lock(&m_lock);
+    requests = m_requests;
+    m_requests = 0U;
+    pthread_mutex_unlock(&m_lock);
+
+    return requests;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void *prj_sim_ntp_thread(void *p_arg)
+{
+    struct pollfd fds[PRJ_SIM_NTP_SERVERS] = {0};
+    prj_sim_ntp_pending_t due = {0};
+    prj_i64_t now_us = 0;
+
+    for (prj_u8_t i = 0U; i < m_count; i++)
+    {
+        fds[i].fd = m_fds[i];
+        fds[i].events = POLLIN;
+    }
+
+    for (;;)
+    {
+        poll(fds, m_count, PRJ_SIM_NTP_POLL_MS);
+        now_us = prj_sim_clock_ref_us();
+
+        for (prj_u8_t i = 0U; i < m_count; i++)
+        {
+            if (fds[i].revents & POLLIN)
+            {
+                prj_sim_ntp_receive(i, now_us);
+            }
+        }
+
+        for (prj_u32_t i = 0U; i < PRJ_SIM_NTP_PENDING_MAX; i++)
+        {
+            due.used = false;
+
+            pthread_mutex_lock(&m_lock);
+
+            if (m_pending[i].used && (m_pending[i].due_us <= now_us))
+            {
+                due = m_pending[i];
+                m_pending[i].used = false;
+            }
+
+            pthread_mutex_unlock(&m_lock);
+
+            if (due.used)
+            {
+                sendto(m_fds[due.server], due.packet, sizeof(due.packet), 0, (struct sockaddr *)&due.addr, sizeof(due.addr));
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static void prj_sim_ntp_receive(const prj_u8_t server, const prj_i64_t now_us)
+{
+    prj_u8_t request[PRJ_SIM_NTP_PACKET_SIZE] = {0};
+    prj_sim_ntp_pending_t reply = {0};
+    prj_sim_ntp_server_t config = {0};
+    socklen_t len = sizeof(reply.addr);
+    ssize_t size = 0;
+    prj_i64_t half_us = 0;
+
+    size = recvfrom(m_fds[server], request, sizeof(request), 0, (struct sockaddr *)&reply.addr, &len);
+
+    pthread_mutex_lock(&m_lock);
+    config = m_servers[server];
+    m_requests++;
+    pthread_mutex_unlock(&m_lock);
+
+    if ((size < (ssize_t)sizeof(request)) || config.dead || ((prj_u32_t)(rand_r(&m_seed) % 100U) < config.loss_pct))
+    {
+        return;
+    }
+
+    /* Half of the delay on the way in, half on the way out, so the offset stays exact */
+    half_us = (prj_i64_t)config.delay_ms * 500LL;
+
+    reply.packet[0] = PRJ_SIM_NTP_MODE_SERVER;
+    reply.packet[1] = PRJ_SIM_NTP_STRATUM;
+    memcpy(&reply.packet[12], "SIM", 4U);
+    memcpy(&reply.packet[PRJ_SIM_NTP_OFF_ORIGIN], &request[PRJ_SIM_NTP_OFF_TRANSMIT], 8U);
+    prj_sim_ntp_ts_write(&reply.packet[PRJ_SIM_NTP_OFF_RECEIVE], now_us + half_us);
+    prj_sim_ntp_ts_write(&reply.packet[PRJ_SIM_NTP_OFF_TRANSMIT], now_us + half_us);
+    reply.due_us = now_us + (2 * half_us);
+    reply.server = server;
+    reply.used = true;
+
+    pthread_mutex_lock(&m_lock);
+
+    for (prj_u32_t i = 0U; i < PRJ_SIM_NTP_PENDING_MAX; i++)
+    {
+        if (!m_pending[i].used)
+        {
+            m_pending[i] = reply;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&m_lock);
+
+    return;
+}
+
+static void prj_sim_ntp_ts_write(prj_u8_t *const p_buf, const prj_i64_t unix_us)
+{
+    prj_u32_t sec = (prj_u32_t)((unix_us / 1000000LL) + PRJ_SIM_NTP_UNIX_OFFSET);
+    prj_u32_t frac = (prj_u32_t)(((unix_us % 1000000LL) << 32) / 1000000LL);
+
+    for (prj_u8_t i = 0U; i < 4U; i++)
+    {
+        p_buf[i] = (prj_u8_t)(sec >> (24U - (8U * i)));
+        p_buf[4U + i] = (prj_u8_t)(frac >> (24U - (8U * i)));
+    }
+
+    return;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,265 @@
+/**
+ * @file host_sim_roam.c
+ * @date 06/06/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "host_sim.h"
+#include "wifi_sta_roam.h"
+
+#include <string.h>
+#include <time.h>
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_SIM_ROAM_STEP_MAX   (16U)
+#define PRJ_SIM_ROAM_ACTION_MAX (16U)
+#define PRJ_SIM_ROAM_APS        (3U) /* AP n has BSSID 02:00:00:00:00:0n */
+#define PRJ_SIM_ROAM_STEP_CALLS (1000000U)
+#define PRJ_SIM_ROAM_US_PER_SEC (1000000LL)
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+/* Trace steps, time in seconds */
+#define PRJ_SIM_ROAM_CONNECT(t)      {(t), PRJ_WIFI_STA_ROAM_INPUT_CONNECT, 0, {0}}
+#define PRJ_SIM_ROAM_CONNECTED(t, n) {(t), PRJ_WIFI_STA_ROAM_INPUT_CONNECTED, (n), {0}}
+#define PRJ_SIM_ROAM_DISC(t)         {(t), PRJ_WIFI_STA_ROAM_INPUT_DISCONNECTED, 0, {0}}
+#define PRJ_SIM_ROAM_RSSI(t, dbm)    {(t), PRJ_WIFI_STA_ROAM_INPUT_RSSI, (dbm), {0}}
+#define PRJ_SIM_ROAM_SCAN(t, ...)    {(t), PRJ_WIFI_STA_ROAM_INPUT_SCAN_DONE, 0, {__VA_ARGS__}}
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    prj_u32_t time_s;
+    prj_wifi_sta_roam_input_type_t type;
+    prj_i8_t value;                   /*!< RSSI sample, or the AP number for a connected step */
+    prj_i8_t scan[PRJ_SIM_ROAM_APS];  /*!< Scan result RSSI of AP 1..3, 0 if not heard */
+} prj_sim_roam_step_t;
+
+typedef struct
+{
+    const prj_char_t *p_name;
+    const prj_char_t *p_expected; /*!< S scan, Pn pin AP n, D disconnect, U unpin */
+    prj_sim_roam_step_t steps[PRJ_SIM_ROAM_STEP_MAX];
+    prj_size_t count;
+} prj_sim_roam_trace_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static prj_bool_t prj_sim_roam_replay(const prj_sim_roam_trace_t *const p_trace, prj_char_t *const p_actions);
+static void prj_sim_roam_append(const prj_wifi_sta_roam_output_t *const p_out, prj_char_t *const p_actions);
+static void prj_sim_roam_bssid(const prj_u8_t number, prj_u8_t *const p_bssid);
+static prj_u32_t prj_sim_roam_step_ns(void);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+/* Fixed values so the expected sequences do not follow the Kconfig defaults */
+static const prj_wifi_sta_roam_config_t m_config = {
+    .scan_rssi     = -70,
+    .hysteresis_db = 8U,
+    .scan_min_us   = 30U * PRJ_SIM_ROAM_US_PER_SEC,
+    .scan_max_us   = 120U * PRJ_SIM_ROAM_US_PER_SEC,
+    .cache_ttl_us  = 60U * PRJ_SIM_ROAM_US_PER_SEC,
+    .ban_us        = 300U * PRJ_SIM_ROAM_US_PER_SEC,
+};
+
+static const prj_sim_roam_trace_t m_traces[] = {
+    /* A good signal never costs a scan */
+    {"strong_idle", "",
+     {PRJ_SIM_ROAM_CONNECTED(0U, 1), PRJ_SIM_ROAM_RSSI(5U, -50), PRJ_SIM_ROAM_RSSI(40U, -55),
+      PRJ_SIM_ROAM_RSSI(100U, -50)}, 4U},
+    /* One deep sample is smoothed away */
+    {"rssi_spike", "",
+     {PRJ_SIM_ROAM_CONNECTED(0U, 1), PRJ_SIM_ROAM_RSSI(30U, -60), PRJ_SIM_ROAM_RSSI(35U, -90),
+      PRJ_SIM_ROAM_RSSI(40U, -60)}, 4U},
+    /* No scan while the average settles on a new AP, then a clearly stronger AP wins */
+    {"weak_roam", "SP2D",
+     {PRJ_SIM_ROAM_CONNECTED(0U, 1), PRJ_SIM_ROAM_RSSI(5U, -78), PRJ_SIM_ROAM_RSSI(35U, -78),
+      PRJ_SIM_ROAM_SCAN(37U, -78, -60, 0), PRJ_SIM_ROAM_DISC(38U), PRJ_SIM_ROAM_CONNECT(38U),
+      PRJ_SIM_ROAM_CONNECTED(39U, 2), PRJ_SIM_ROAM_RSSI(70U, -60)}, 8U},
+    /* 6 dB better is inside the hysteresis, the scan period doubles up to its cap */
+    {"hysteresis", "SSS",
+     {PRJ_SIM_ROAM_CONNECTED(0U, 1), PRJ_SIM_ROAM_RSSI(30U, -75), PRJ_SIM_ROAM_SCAN(32U, -75, -69, 0),
+      PRJ_SIM_ROAM_RSSI(50U, -75), PRJ_SIM_ROAM_RSSI(62U, -75), PRJ_SIM_ROAM_SCAN(64U, 0, -70, 0),
+      PRJ_SIM_ROAM_RSSI(100U, -75), PRJ_SIM_ROAM_RSSI(124U, -75)}, 8U},
+    /* The roam target does not answer: it is banned, the next connect takes the fresh AP 1 */
+    {"dead_target", "SP2DUP1S",
+     {PRJ_SIM_ROAM_CONNECTED(0U, 1), PRJ_SIM_ROAM_RSSI(30U, -80), PRJ_SIM_ROAM_SCAN(32U, -80, -60, 0),
+      PRJ_SIM_ROAM_DISC(33U), PRJ_SIM_ROAM_CONNECT(33U), PRJ_SIM_ROAM_DISC(35U), PRJ_SIM_ROAM_CONNECT(36U),
+      PRJ_SIM_ROAM_CONNECTED(37U, 1), PRJ_SIM_ROAM_RSSI(67U, -80), PRJ_SIM_ROAM_SCAN(69U, -80, -60, 0)}, 10U},
+    /* After a link loss the strongest cached AP is pinned instead of a full scan */
+    {"reconnect_pick", "SP3",
+     {PRJ_SIM_ROAM_CONNECTED(0U, 1), PRJ_SIM_ROAM_RSSI(30U, -74), PRJ_SIM_ROAM_SCAN(31U, -74, -68, -67),
+      PRJ_SIM_ROAM_DISC(40U), PRJ_SIM_ROAM_CONNECT(41U)}, 5U},
+    /* Results past their lifetime leave the choice to the driver */
+    {"stale_cache", "S",
+     {PRJ_SIM_ROAM_CONNECTED(0U, 1), PRJ_SIM_ROAM_RSSI(30U, -74), PRJ_SIM_ROAM_SCAN(31U, 0, 0, -67),
+      PRJ_SIM_ROAM_DISC(100U), PRJ_SIM_ROAM_CONNECT(101U)}, 5U},
+    /* A recovered signal resets the backed off period, the next drop scans at once */
+    {"recovery_rate", "SSS",
+     {PRJ_SIM_ROAM_CONNECTED(0U, 1), PRJ_SIM_ROAM_RSSI(30U, -75), PRJ_SIM_ROAM_SCAN(31U, 0, 0, 0),
+      PRJ_SIM_ROAM_RSSI(61U, -75), PRJ_SIM_ROAM_SCAN(62U, 0, 0, 0), PRJ_SIM_ROAM_RSSI(70U, -50),
+      PRJ_SIM_ROAM_RSSI(75U, -50), PRJ_SIM_ROAM_RSSI(80U, -50), PRJ_SIM_ROAM_RSSI(85U, -50),
+      PRJ_SIM_ROAM_RSSI(90U, -90), PRJ_SIM_ROAM_RSSI(95U, -90)}, 11U},
+    /* The roamed-to AP is lost after its scan result expired: the pin is dropped, not retried forever */
+    {"pin_release", "SP2DU",
+     {PRJ_SIM_ROAM_CONNECTED(0U, 1), PRJ_SIM_ROAM_RSSI(30U, -80), PRJ_SIM_ROAM_SCAN(32U, -80, -60, 0),
+      PRJ_SIM_ROAM_DISC(33U), PRJ_SIM_ROAM_CONNECT(33U), PRJ_SIM_ROAM_CONNECTED(34U, 2),
+      PRJ_SIM_ROAM_RSSI(40U, -60), PRJ_SIM_ROAM_RSSI(120U, -60), PRJ_SIM_ROAM_DISC(200U),
+      PRJ_SIM_ROAM_CONNECT(201U), PRJ_SIM_ROAM_DISC(203U), PRJ_SIM_ROAM_CONNECT(204U)}, 12U},
+};
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void prj_sim_roam_run(prj_sim_roam_result_t *const p_result)
+{
+    prj_char_t actions[PRJ_SIM_ROAM_ACTION_MAX + 1U] = {0};
+    prj_bool_t passed = false;
+
+    memset(p_result, 0, sizeof(*p_result));
+
+    for (prj_size_t i = 0U; i < (sizeof(m_traces) / sizeof(m_traces[0])); i++)
+    {
+        passed = prj_sim_roam_replay(&m_traces[i], actions);
+        p_result->traces++;
+        p_result->failed += passed ? 0U : 1U;
+
+        ESP_LOGI(PRJ_SIM_TAG, "bench: roam %-16s actions=%-8s expected=%-8s %s", m_traces[i].p_name, actions,
+                 m_traces[i].p_expected, passed ? "PASS" : "FAIL");
+    }
+
+    p_result->step_ns = prj_sim_roam_step_ns();
+
+    return;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static prj_bool_t prj_sim_roam_replay(const prj_sim_roam_trace_t *const p_trace, prj_char_t *const p_actions)
+{
+    prj_wifi_sta_roam_t roam = {0};
+    prj_wifi_sta_roam_ap_t aps[PRJ_SIM_ROAM_APS] = {0};
+    prj_wifi_sta_roam_input_t input = {0};
+    prj_wifi_sta_roam_output_t out = {0};
+    prj_u8_t bssid[PRJ_WIFI_STA_ROAM_BSSID_LEN] = {0};
+
+    p_actions[0] = '\0';
+    prj_wifi_sta_roam_init(&roam, &m_config);
+
+    for (prj_size_t i = 0U; i < p_trace->count; i++)
+    {
+        const prj_sim_roam_step_t *p_step = &p_trace->steps[i];
+
+        input = (prj_wifi_sta_roam_input_t){
+            .type   = p_step->type,
+            .now_us = (prj_i64_t)p_step->time_s * PRJ_SIM_ROAM_US_PER_SEC,
+            .rssi   = p_step->value,
+            .p_aps  = aps,
+        };
+
+        if (p_step->type == PRJ_WIFI_STA_ROAM_INPUT_CONNECTED)
+        {
+            prj_sim_roam_bssid((prj_u8_t)p_step->value, bssid);
+            input.p_bssid = bssid;
+        }
+
+        for (prj_u8_t ap = 0U; (p_step->type == PRJ_WIFI_STA_ROAM_INPUT_SCAN_DONE) && (ap < PRJ_SIM_ROAM_APS); ap++)
+        {
+            if (p_step->scan[ap] != 0)
+            {
+                prj_sim_roam_bssid(ap + 1U, aps[input.count].bssid);
+                aps[input.count].channel = (prj_u8_t)(1U + (5U * ap));
+                aps[input.count].rssi = p_step->scan[ap];
+                input.count++;
+            }
+        }
+
+        out = prj_wifi_sta_roam_step(&roam, &input);
+        prj_sim_roam_append(&out, p_actions);
+    }
+
+    return (strcmp(p_actions, p_trace->p_expected) == 0);
+}
+
+static void prj_sim_roam_append(const prj_wifi_sta_roam_output_t *const p_out, prj_char_t *const p_actions)
+{
+    prj_size_t len = strlen(p_actions);
+
+    /* Same order the driver glue carries them out in */
+    if (((p_out->actions & PRJ_WIFI_STA_ROAM_ACTION_PIN) != 0U) && (len < (PRJ_SIM_ROAM_ACTION_MAX - 1U)))
+    {
+        p_actions[len++] = 'P';
+        p_actions[len++] = (prj_char_t)('0' + p_out->target.bssid[PRJ_WIFI_STA_ROAM_BSSID_LEN - 1U]);
+    }
+
+    if (((p_out->actions & PRJ_WIFI_STA_ROAM_ACTION_UNPIN) != 0U) && (len < PRJ_SIM_ROAM_ACTION_MAX))
+    {
+        p_actions[len++] = 'U';
+    }
+
+    if (((p_out->actions & PRJ_WIFI_STA_ROAM_ACTION_SCAN) != 0U) && (len < PRJ_SIM_ROAM_ACTION_MAX))
+    {
+        p_actions[len++] = 'S';
+    }
+
+    if (((p_out->actions & PRJ_WIFI_STA_ROAM_ACTION_DISCONNECT) != 0U) && (len < PRJ_SIM_ROAM_ACTION_MAX))
+    {
+        p_actions[len++] = 'D';
+    }
+
+    p_actions[len] = '\0';
+
+    return;
+}
+
+static void prj_sim_roam_bssid(const prj_u8_t number, prj_u8_t *const p_bssid)
+{
+    const prj_u8_t bssid[PRJ_WIFI_STA_ROAM_BSSID_LEN] = {0x02, 0x00, 0x00, 0x00, 0x00, number};
+
+    memcpy(p_bssid, bssid, sizeof(bssid));
+
+    return;
+}
+
+static prj_u32_t prj_sim_roam_step_ns(void)
+{
+    prj_wifi_sta_roam_t roam = {0};
+    prj_wifi_sta_roam_input_t input = {0};
+    prj_u8_t bssid[PRJ_WIFI_STA_ROAM_BSSID_LEN] = {0};
+    struct timespec start = {0};
+    struct timespec end = {0};
+    volatile prj_u32_t sink = 0U;
+
+    prj_wifi_sta_roam_init(&roam, &m_config);
+    prj_sim_roam_bssid(1U, bssid);
+    input = (prj_wifi_sta_roam_input_t){.type = PRJ_WIFI_STA_ROAM_INPUT_CONNECTED, .p_bssid = bssid};
+    prj_wifi_sta_roam_step(&roam, &input);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* The periodic sample is the only input fed all the time */
+    for (prj_u32_t i = 0U; i < PRJ_SIM_ROAM_STEP_CALLS; i++)
+    {
+        input = (prj_wifi_sta_roam_input_t){
+            .type   = PRJ_WIFI_STA_ROAM_INPUT_RSSI,
+            .now_us = (prj_i64_t)i,
+            .rssi   = (prj_i8_t)(-50 - (prj_i32_t)(i & 0x1FU)),
+        };
+        sink += prj_wifi_sta_roam_step(&roam, &input).actions;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    (void)sink;
+
+    return (prj_u32_t)((((prj_i64_t)(end.tv_sec - start.tv_sec) * 1000000000LL) + (end.tv_nsec - start.tv_nsec)) /
+                       PRJ_SIM_ROAM_STEP_CALLS);
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,240 @@
+/**
+ * @file esp_event.c
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "esp_event.h"
+
+#include <string.h>
+#include <stdbool.h>
+#include "freertos/task.h"
+#include "freertos/queue.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define ESP_EVENT_STUB_HANDLER_MAX (16U)
+#define ESP_EVENT_STUB_QUEUE_LEN   (32U)
+#define ESP_EVENT_STUB_DATA_MAX    (128U)
+#define ESP_EVENT_STUB_TASK_STACK  (4096U)
+#define ESP_EVENT_STUB_TASK_PRIO   (20U)
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t handler;
+    void *p_arg;
+    bool used;
+} esp_event_stub_handler_t;
+
+typedef struct
+{
+    esp_event_base_t base;
+    int32_t id;
+    size_t size;
+    uint8_t data[ESP_EVENT_STUB_DATA_MAX];
+} esp_event_stub_post_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void esp_event_stub_task(void *p_arg);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_event_stub_handler_t m_handlers[ESP_EVENT_STUB_HANDLER_MAX];
+static QueueHandle_t m_queue = NULL;
+static TaskHandle_t m_task = NULL;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+esp_err_t esp_event_loop_create_default(void)
+{
+    if (m_queue != NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    m_queue = xQueueCreate(ESP_EVENT_STUB_QUEUE_LEN, sizeof(esp_event_stub_post_t));
+
+    if ((m_queue == NULL) ||
+        (xTaskCreate(esp_event_stub_task, "sys_evt", ESP_EVENT_STUB_TASK_STACK, NULL, ESP_EVENT_STUB_TASK_PRIO, &m_task) != pdPASS))
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_event_loop_delete_default(void)
+{
+    if (m_queue == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    vTaskDelete(m_task);
+    vQueueDelete(m_queue);
+    m_task = NULL;
+    m_queue = NULL;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_register(esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler,
+                                     void *event_handler_arg)
+{
+    return esp_event_handler_instance_register(event_base, event_id, event_handler, event_handler_arg, NULL);
+}
+
+esp_err_t esp_event_handler_unregister(esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler)
+{
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    portENTER_CRITICAL(&m_lock);
+
+    for (uint32_t i = 0U; i < ESP_EVENT_STUB_HANDLER_MAX; i++)
+    {
+        if (m_handlers[i].used && (m_handlers[i].base == event_base) && (m_handlers[i].id == event_id) &&
+            (m_handlers[i].handler == event_handler))
+        {
+            m_handlers[i].used = false;
+            err = ESP_OK;
+            break;
+        }
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    return err;
+}
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler,
+                                              void *event_handler_arg, esp_event_handler_instance_t *instance)
+{
+    esp_event_stub_handler_t *p_slot = NULL;
+
+    if (event_handler == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+
+    for (uint32_t i = 0U; i < ESP_EVENT_STUB_HANDLER_MAX; i++)
+    {
+        if (!m_handlers[i].used)
+        {
+            p_slot = &m_handlers[i];
+            p_slot->base = event_base;
+            p_slot->id = event_id;
+            p_slot->handler = event_handler;
+            p_slot->p_arg = event_handler_arg;
+            p_slot->used = true;
+            break;
+        }
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    if (instance != NULL)
+    {
+        *instance = p_slot;
+    }
+
+    return (p_slot != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_event_handler_instance_unregister(esp_event_base_t event_base, int32_t event_id,
+                                                esp_event_handler_instance_t instance)
+{
+    esp_event_stub_handler_t *p_slot = (esp_event_stub_handler_t *)instance;
+
+    if (p_slot == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+    p_slot->used = false;
+    portEXIT_CRITICAL(&m_lock);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id, const void *event_data, size_t event_data_size,
+                         TickType_t ticks_to_wait)
+{
+    esp_event_stub_post_t post = {
+        .base = event_base,
+        .id   = event_id,
+        .size = event_data_size,
+    };
+
+    if (m_queue == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (event_data_size > sizeof(post.data))
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if (event_data != NULL)
+    {
+        memcpy(post.data, event_data, event_data_size);
+    }
+
+    return (xQueueSend(m_queue, &post, ticks_to_wait) == pdTRUE) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void esp_event_stub_task(void *p_arg)
+{
+    esp_event_stub_handler_t handlers[ESP_EVENT_STUB_HANDLER_MAX];
+    esp_event_stub_post_t post = {0};
+    uint32_t count = 0U;
+
+    for (;;)
+    {
+        if (xQueueReceive(m_queue, &post, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+
+        /* Handlers may register or unregister others, dispatch from a snapshot */
+        count = 0U;
+        portENTER_CRITICAL(&m_lock);
+
+        for (uint32_t i = 0U; i < ESP_EVENT_STUB_HANDLER_MAX; i++)
+        {
+            if (m_handlers[i].used &&
+                ((m_handlers[i].base == ESP_EVENT_ANY_BASE) || (m_handlers[i].base == post.base)) &&
+                ((m_handlers[i].id == ESP_EVENT_ANY_ID) || (m_handlers[i].id == post.id)))
+            {
+                handlers[count++] = m_handlers[i];
+            }
+        }
+
+        portEXIT_CRITICAL(&m_lock);
+
+        for (uint32_t i = 0U; i < count; i++)
+        {
+            handlers[i].handler(handlers[i].p_arg, post.base, post.id, (post.size != 0U) ? post.data : NULL);
+        }
+    }
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,55 @@
+/**
+ * @file esp_event.h
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ *
+ * Host stub of the ESP-IDF default event loop. Events are copied into a queue and dispatched in
+ * order from one FreeRTOS task, like the real "sys_evt" task.
+ */
+
+#ifndef ESP_EVENT_H
+#define ESP_EVENT_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define ESP_EVENT_ANY_BASE NULL
+#define ESP_EVENT_ANY_ID   (-1)
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+#define ESP_EVENT_DECLARE_BASE(id) extern esp_event_base_t const id
+#define ESP_EVENT_DEFINE_BASE(id)  esp_event_base_t const id = #id
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef const char *esp_event_base_t;
+typedef void *esp_event_handler_instance_t;
+typedef void (*esp_event_handler_t)(void *event_handler_arg, esp_event_base_t event_base, int32_t event_id, void *event_data);
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+esp_err_t esp_event_loop_create_default(void);
+esp_err_t esp_event_loop_delete_default(void);
+esp_err_t esp_event_handler_register(esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler,
+                                     void *event_handler_arg);
+esp_err_t esp_event_handler_unregister(esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler);
+esp_err_t esp_event_handler_instance_register(esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler,
+                                              void *event_handler_arg, esp_event_handler_instance_t *instance);
+esp_err_t esp_event_handler_instance_unregister(esp_event_base_t event_base, int32_t event_id,
+                                                esp_event_handler_instance_t instance);
+esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id, const void *event_data, size_t event_data_size,
+                         TickType_t ticks_to_wait);
+#endif /* ESP_EVENT_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,55 @@
+/**
+ * @file esp_netif.c
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "esp_netif.h"
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+struct esp_netif_obj
+{
+    bool used;
+};
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+ESP_EVENT_DEFINE_BASE(IP_EVENT);
+
+static struct esp_netif_obj m_netif_sta;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+esp_err_t esp_netif_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_deinit(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void)
+{
+    m_netif_sta.used = true;
+
+    return &m_netif_sta;
+}
+
+void esp_netif_destroy_default_wifi(void *esp_netif)
+{
+    ((esp_netif_t *)esp_netif)->used = false;
+
+    return;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
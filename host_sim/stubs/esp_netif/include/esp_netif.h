@@ -0,0 +1,74 @@
+/**
+ * @file esp_netif.h
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ *
+ * Host stub of the ESP-IDF esp_netif API, only the types and calls used by the station.
+ */
+
+#ifndef ESP_NETIF_H
+#define ESP_NETIF_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_event.h"
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+#define esp_ip4_addr1_16(ipaddr) ((uint16_t)(((ipaddr)->addr) & 0xFFU))
+#define esp_ip4_addr2_16(ipaddr) ((uint16_t)(((ipaddr)->addr >> 8) & 0xFFU))
+#define esp_ip4_addr3_16(ipaddr) ((uint16_t)(((ipaddr)->addr >> 16) & 0xFFU))
+#define esp_ip4_addr4_16(ipaddr) ((uint16_t)(((ipaddr)->addr >> 24) & 0xFFU))
+
+#define IPSTR          "%d.%d.%d.%d"
+#define IP2STR(ipaddr) esp_ip4_addr1_16(ipaddr), esp_ip4_addr2_16(ipaddr), esp_ip4_addr3_16(ipaddr), esp_ip4_addr4_16(ipaddr)
+
+#define ESP_IP4TOADDR(a, b, c, d) ((uint32_t)(((d) & 0xFFU) << 24) | (((c) & 0xFFU) << 16) | (((b) & 0xFFU) << 8) | ((a) & 0xFFU))
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+ESP_EVENT_DECLARE_BASE(IP_EVENT);
+
+typedef enum
+{
+    IP_EVENT_STA_GOT_IP,
+    IP_EVENT_STA_LOST_IP,
+} ip_event_t;
+
+typedef struct esp_netif_obj esp_netif_t;
+
+typedef struct
+{
+    uint32_t addr;
+} esp_ip4_addr_t;
+
+typedef struct
+{
+    esp_ip4_addr_t ip;
+    esp_ip4_addr_t netmask;
+    esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+typedef struct
+{
+    esp_netif_t *esp_netif;
+    esp_netif_ip_info_t ip_info;
+    bool ip_changed;
+} ip_event_got_ip_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+esp_err_t esp_netif_init(void);
+esp_err_t esp_netif_deinit(void);
+esp_netif_t *esp_netif_create_default_wifi_sta(void);
+void esp_netif_destroy_default_wifi(void *esp_netif);
+#endif /* ESP_NETIF_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
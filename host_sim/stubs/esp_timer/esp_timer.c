@@ -0,0 +1,246 @@
+/**
+ * @file esp_timer.c
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "esp_timer.h"
+
+#include <time.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define ESP_TIMER_STUB_MAX        (16U)
+#define ESP_TIMER_STUB_TASK_STACK (4096U)
+#define ESP_TIMER_STUB_TASK_PRIO  (configMAX_PRIORITIES - 2U)
+#define ESP_TIMER_STUB_IDLE_MS    (100U)
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+struct esp_timer
+{
+    esp_timer_create_args_t args;
+    int64_t due_us;
+    uint64_t period_us;
+    bool used;
+    bool armed;
+};
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void esp_timer_stub_task(void *p_arg);
+static esp_err_t esp_timer_stub_arm(esp_timer_handle_t timer, const uint64_t timeout_us, const uint64_t period_us);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+static struct esp_timer m_timers[ESP_TIMER_STUB_MAX];
+static TaskHandle_t m_task = NULL;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((int64_t)ts.tv_sec * 1000000LL) + (ts.tv_nsec / 1000);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    esp_timer_handle_t timer = NULL;
+
+    if ((create_args == NULL) || (create_args->callback == NULL) || (out_handle == NULL))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if ((m_task == NULL) &&
+        (xTaskCreate(esp_timer_stub_task, "esp_timer", ESP_TIMER_STUB_TASK_STACK, NULL, ESP_TIMER_STUB_TASK_PRIO, &m_task) != pdPASS))
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+
+    for (uint32_t i = 0U; i < ESP_TIMER_STUB_MAX; i++)
+    {
+        if (!m_timers[i].used)
+        {
+            timer = &m_timers[i];
+            timer->args = *create_args;
+            timer->armed = false;
+            timer->used = true;
+            break;
+        }
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    *out_handle = timer;
+
+    return (timer != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return esp_timer_stub_arm(timer, timeout_us, 0U);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    return esp_timer_stub_arm(timer, period, period);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    esp_err_t err = ESP_OK;
+
+    if (timer == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+    err = timer->armed ? ESP_OK : ESP_ERR_INVALID_STATE;
+    timer->armed = false;
+    portEXIT_CRITICAL(&m_lock);
+
+    return err;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    esp_err_t err = ESP_OK;
+
+    if (timer == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+
+    if (timer->armed)
+    {
+        err = ESP_ERR_INVALID_STATE;
+    }
+    else
+    {
+        timer->used = false;
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    return err;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer)
+{
+    return (timer != NULL) && timer->armed;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static esp_err_t esp_timer_stub_arm(esp_timer_handle_t timer, const uint64_t timeout_us, const uint64_t period_us)
+{
+    esp_err_t err = ESP_OK;
+
+    if (timer == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+
+    if (timer->armed)
+    {
+        err = ESP_ERR_INVALID_STATE;
+    }
+    else
+    {
+        timer->due_us = esp_timer_get_time() + (int64_t)timeout_us;
+        timer->period_us = period_us;
+        timer->armed = true;
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    xTaskNotifyGive(m_task);
+
+    return err;
+}
+
+static void esp_timer_stub_task(void *p_arg)
+{
+    esp_timer_handle_t p_due = NULL;
+    esp_timer_cb_t callback = NULL;
+    void *p_cb_arg = NULL;
+    int64_t now_us = 0;
+    int64_t next_us = 0;
+
+    for (;;)
+    {
+        p_due = NULL;
+        now_us = esp_timer_get_time();
+        next_us = now_us + (ESP_TIMER_STUB_IDLE_MS * 1000LL);
+
+        portENTER_CRITICAL(&m_lock);
+
+        for (uint32_t i = 0U; i < ESP_TIMER_STUB_MAX; i++)
+        {
+            if (!m_timers[i].armed)
+            {
+                continue;
+            }
+
+            if ((p_due == NULL) && (m_timers[i].due_us <= now_us))
+            {
+                p_due = &m_timers[i];
+            }
+            else if (m_timers[i].due_us < next_us)
+            {
+                next_us = m_timers[i].due_us;
+            }
+        }
+
+        if (p_due != NULL)
+        {
+            callback = p_due->args.callback;
+            p_cb_arg = p_due->args.arg;
+
+            if (p_due->period_us != 0U)
+            {
+                p_due->due_us += (int64_t)p_due->period_us;
+            }
+            else
+            {
+                p_due->armed = false;
+            }
+        }
+
+        portEXIT_CRITICAL(&m_lock);
+
+        if (p_due != NULL)
+        {
+            callback(p_cb_arg);
+            continue;
+        }
+
+        /* Round up, a timer must never fire early */
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((uint32_t)((next_us - now_us + 999) / 1000)) + 1U);
+    }
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,55 @@
+/**
+ * @file esp_timer.h
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ *
+ * Host stub of the ESP-IDF esp_timer API. Callbacks run in one FreeRTOS task, time is CLOCK_MONOTONIC.
+ */
+
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct esp_timer *esp_timer_handle_t;
+
+typedef void (*esp_timer_cb_t)(void *arg);
+
+typedef enum
+{
+    ESP_TIMER_TASK,
+    ESP_TIMER_ISR,
+    ESP_TIMER_MAX,
+} esp_timer_dispatch_t;
+
+typedef struct
+{
+    esp_timer_cb_t callback;
+    void *arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char *name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+int64_t esp_timer_get_time(void);
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+bool esp_timer_is_active(esp_timer_handle_t timer);
+#endif /* ESP_TIMER_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,326 @@
+/**
+ * @file esp_wifi.c
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "esp_wifi.h"
+#include "prj_sim_wifi.h"
+
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define PRJ_SIM_WIFI_POST_TOUT (pdMS_TO_TICKS(100U))
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef enum
+{
+    PRJ_SIM_WIFI_STATE_STOPPED = 0,
+    PRJ_SIM_WIFI_STATE_IDLE,
+    PRJ_SIM_WIFI_STATE_ASSOC,
+    PRJ_SIM_WIFI_STATE_DHCP,
+    PRJ_SIM_WIFI_STATE_CONNECTED,
+} prj_sim_wifi_state_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void prj_sim_wifi_timer_cb(void *p_arg);
+static void prj_sim_wifi_disconnected_post(const prj_u8_t reason);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+ESP_EVENT_DEFINE_BASE(WIFI_EVENT);
+
+static portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t m_timer = NULL;
+static prj_sim_wifi_state_t m_state = PRJ_SIM_WIFI_STATE_STOPPED;
+static wifi_config_t m_config = {0};
+static prj_sim_wifi_stats_t m_stats = {0};
+static prj_sim_wifi_ap_t m_ap = {
+    .assoc_delay_ms = 50U,
+    .dhcp_delay_ms  = 20U,
+    .bssid          = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01},
+    .channel        = 6U,
+    .ip             = ESP_IP4TOADDR(192, 168, 4, 2),
+    .rssi           = -55,
+};
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+esp_err_t esp_wifi_init(const wifi_init_config_t *config)
+{
+    const esp_timer_create_args_t timer_args = {
+        .callback = prj_sim_wifi_timer_cb,
+        .name     = "sim_wifi",
+    };
+
+    if (m_timer != NULL)
+    {
+        return ESP_OK;
+    }
+
+    return esp_timer_create(&timer_args, &m_timer);
+}
+
+esp_err_t esp_wifi_deinit(void)
+{
+    if (m_state != PRJ_SIM_WIFI_STATE_STOPPED)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_timer_delete(m_timer);
+    m_timer = NULL;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode)
+{
+    return (mode == WIFI_MODE_STA) ? ESP_OK : ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+    portENTER_CRITICAL(&m_lock);
+    m_config = *conf;
+    portEXIT_CRITICAL(&m_lock);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+    portENTER_CRITICAL(&m_lock);
+    *conf = m_config;
+    portEXIT_CRITICAL(&m_lock);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_start(void)
+{
+    if (m_timer == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    m_state = PRJ_SIM_WIFI_STATE_IDLE;
+
+    return esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_START, NULL, 0U, PRJ_SIM_WIFI_POST_TOUT);
+}
+
+esp_err_t esp_wifi_stop(void)
+{
+    esp_timer_stop(m_timer);
+    m_state = PRJ_SIM_WIFI_STATE_STOPPED;
+
+    return esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_STOP, NULL, 0U, PRJ_SIM_WIFI_POST_TOUT);
+}
+
+esp_err_t esp_wifi_connect(void)
+{
+    prj_u32_t delay_ms = 0U;
+
+    portENTER_CRITICAL(&m_lock);
+
+    if (m_state != PRJ_SIM_WIFI_STATE_IDLE)
+    {
+        portEXIT_CRITICAL(&m_lock);
+        return (m_state == PRJ_SIM_WIFI_STATE_STOPPED) ? ESP_ERR_INVALID_STATE : ESP_ERR_INVALID_ARG;
+    }
+
+    m_state = PRJ_SIM_WIFI_STATE_ASSOC;
+    m_stats.connect_calls++;
+    delay_ms = m_ap.assoc_delay_ms;
+
+    portEXIT_CRITICAL(&m_lock);
+
+    esp_timer_start_once(m_timer, (uint64_t)delay_ms * 1000U);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_disconnect(void)
+{
+    prj_bool_t was_connected = false;
+
+    esp_timer_stop(m_timer);
+
+    portENTER_CRITICAL(&m_lock);
+    was_connected = (m_state != PRJ_SIM_WIFI_STATE_STOPPED) && (m_state != PRJ_SIM_WIFI_STATE_IDLE);
+    m_state = (m_state == PRJ_SIM_WIFI_STATE_STOPPED) ? m_state : PRJ_SIM_WIFI_STATE_IDLE;
+    portEXIT_CRITICAL(&m_lock);
+
+    if (was_connected)
+    {
+        prj_sim_wifi_disconnected_post(WIFI_REASON_ASSOC_LEAVE);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_rssi(int *rssi)
+{
+    esp_err_t err = ESP_OK;
+
+    portENTER_CRITICAL(&m_lock);
+
+    if ((m_state == PRJ_SIM_WIFI_STATE_CONNECTED) || (m_state == PRJ_SIM_WIFI_STATE_DHCP))
+    {
+        *rssi = m_ap.rssi;
+    }
+    else
+    {
+        err = ESP_ERR_WIFI_NOT_CONNECT;
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    return err;
+}
+
+void prj_sim_wifi_ap_set(const prj_sim_wifi_ap_t *const p_ap)
+{
+    portENTER_CRITICAL(&m_lock);
+    m_ap = *p_ap;
+    portEXIT_CRITICAL(&m_lock);
+
+    return;
+}
+
+void prj_sim_wifi_link_drop(const prj_u32_t fail_count)
+{
+    prj_bool_t was_connected = false;
+
+    esp_timer_stop(m_timer);
+
+    portENTER_CRITICAL(&m_lock);
+    was_connected = (m_state == PRJ_SIM_WIFI_STATE_CONNECTED) || (m_state == PRJ_SIM_WIFI_STATE_DHCP);
+    m_state = (m_state == PRJ_SIM_WIFI_STATE_STOPPED) ? m_state : PRJ_SIM_WIFI_STATE_IDLE;
+    m_ap.fail_count = fail_count;
+    m_stats.dropped += was_connected ? 1U : 0U;
+    portEXIT_CRITICAL(&m_lock);
+
+    if (was_connected)
+    {
+        prj_sim_wifi_disconnected_post(WIFI_REASON_BEACON_TIMEOUT);
+    }
+
+    return;
+}
+
+void prj_sim_wifi_stats_take(prj_sim_wifi_stats_t *const p_stats)
+{
+    portENTER_CRITICAL(&m_lock);
+    *p_stats = m_stats;
+    memset(&m_stats, 0, sizeof(m_stats));
+    portEXIT_CRITICAL(&m_lock);
+
+    return;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void prj_sim_wifi_timer_cb(void *p_arg)
+{
+    wifi_event_sta_connected_t connected = {0};
+    ip_event_got_ip_t got_ip = {0};
+    prj_sim_wifi_state_t state = PRJ_SIM_WIFI_STATE_STOPPED;
+    prj_bool_t fail = false;
+    prj_u32_t delay_ms = 0U;
+
+    portENTER_CRITICAL(&m_lock);
+
+    state = m_state;
+
+    if (state == PRJ_SIM_WIFI_STATE_ASSOC)
+    {
+        /* A connect pinned to a BSSID or channel only finds the AP where it really is */
+        fail = (m_ap.fail_count > 0U) ||
+               (m_config.sta.bssid_set && (memcmp(m_config.sta.bssid, m_ap.bssid, sizeof(m_ap.bssid)) != 0)) ||
+               ((m_config.sta.channel != 0U) && (m_config.sta.channel != m_ap.channel));
+
+        if (fail)
+        {
+            m_ap.fail_count -= (m_ap.fail_count > 0U) ? 1U : 0U;
+            m_stats.failed++;
+            m_state = PRJ_SIM_WIFI_STATE_IDLE;
+        }
+        else
+        {
+            memcpy(connected.ssid, m_config.sta.ssid, sizeof(connected.ssid));
+            connected.ssid_len = (uint8_t)strnlen((const char *)m_config.sta.ssid, sizeof(m_config.sta.ssid));
+            memcpy(connected.bssid, m_ap.bssid, sizeof(connected.bssid));
+            connected.channel = m_ap.channel;
+            connected.authmode = WIFI_AUTH_WPA2_PSK;
+            connected.aid = 1U;
+            delay_ms = m_ap.dhcp_delay_ms;
+            m_stats.connected++;
+            m_state = PRJ_SIM_WIFI_STATE_DHCP;
+        }
+    }
+    else if (state == PRJ_SIM_WIFI_STATE_DHCP)
+    {
+        got_ip.ip_info.ip.addr = m_ap.ip;
+        got_ip.ip_info.netmask.addr = ESP_IP4TOADDR(255, 255, 255, 0);
+        got_ip.ip_info.gw.addr = (m_ap.ip & ESP_IP4TOADDR(255, 255, 255, 0)) | ESP_IP4TOADDR(0, 0, 0, 1);
+        m_state = PRJ_SIM_WIFI_STATE_CONNECTED;
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    if (state == PRJ_SIM_WIFI_STATE_ASSOC)
+    {
+        if (fail)
+        {
+            prj_sim_wifi_disconnected_post(WIFI_REASON_NO_AP_FOUND);
+        }
+        else
+        {
+            esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &connected, sizeof(connected), PRJ_SIM_WIFI_POST_TOUT);
+            esp_timer_start_once(m_timer, (uint64_t)delay_ms * 1000U);
+        }
+    }
+    else if (state == PRJ_SIM_WIFI_STATE_DHCP)
+    {
+        esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, &got_ip, sizeof(got_ip), PRJ_SIM_WIFI_POST_TOUT);
+    }
+
+    return;
+}
+
+static void prj_sim_wifi_disconnected_post(const prj_u8_t reason)
+{
+    wifi_event_sta_disconnected_t disconnected = {
+        .reason = reason,
+        .rssi   = -90,
+    };
+
+    portENTER_CRITICAL(&m_lock);
+    memcpy(disconnected.ssid, m_config.sta.ssid, sizeof(disconnected.ssid));
+    disconnected.ssid_len = (uint8_t)strnlen((const char *)m_config.sta.ssid, sizeof(m_config.sta.ssid));
+    portEXIT_CRITICAL(&m_lock);
+
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &disconnected, sizeof(disconnected), PRJ_SIM_WIFI_POST_TOUT);
+
+    return;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,166 @@
+/**
+ * @file esp_wifi.h
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ *
+ * Host stub of the ESP-IDF station API. The simulated AP is scripted through prj_sim_wifi.h.
+ */
+
+#ifndef ESP_WIFI_H
+#define ESP_WIFI_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+#define WIFI_INIT_CONFIG_DEFAULT() { .magic = 0x1F2F3F4F }
+
+#define ESP_ERR_WIFI_NOT_CONNECT   (0x3000 + 15)
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+ESP_EVENT_DECLARE_BASE(WIFI_EVENT);
+
+typedef enum
+{
+    WIFI_EVENT_WIFI_READY = 0,
+    WIFI_EVENT_SCAN_DONE,
+    WIFI_EVENT_STA_START,
+    WIFI_EVENT_STA_STOP,
+    WIFI_EVENT_STA_CONNECTED,
+    WIFI_EVENT_STA_DISCONNECTED,
+} wifi_event_t;
+
+typedef enum
+{
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WEP,
+    WIFI_AUTH_WPA_PSK,
+    WIFI_AUTH_WPA2_PSK,
+    WIFI_AUTH_WPA_WPA2_PSK,
+    WIFI_AUTH_ENTERPRISE,
+    WIFI_AUTH_WPA3_PSK,
+    WIFI_AUTH_WPA2_WPA3_PSK,
+    WIFI_AUTH_WAPI_PSK,
+    WIFI_AUTH_MAX,
+} wifi_auth_mode_t;
+
+typedef enum
+{
+    WIFI_REASON_ASSOC_LEAVE       = 8,
+    WIFI_REASON_BEACON_TIMEOUT    = 200,
+    WIFI_REASON_NO_AP_FOUND       = 201,
+    WIFI_REASON_AUTH_FAIL         = 202,
+    WIFI_REASON_ASSOC_FAIL        = 203,
+    WIFI_REASON_HANDSHAKE_TIMEOUT = 204,
+    WIFI_REASON_CONNECTION_FAIL   = 205,
+} wifi_err_reason_t;
+
+typedef enum
+{
+    WPA3_SAE_PWE_UNSPECIFIED = 0,
+    WPA3_SAE_PWE_HUNT_AND_PECK,
+    WPA3_SAE_PWE_HASH_TO_ELEMENT,
+    WPA3_SAE_PWE_BOTH,
+} wifi_sae_pwe_method_t;
+
+typedef enum
+{
+    WIFI_FAST_SCAN = 0,
+    WIFI_ALL_CHANNEL_SCAN,
+} wifi_scan_method_t;
+
+typedef enum
+{
+    WIFI_MODE_NULL = 0,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA,
+} wifi_mode_t;
+
+typedef enum
+{
+    WIFI_IF_STA = 0,
+    WIFI_IF_AP,
+} wifi_interface_t;
+
+typedef enum
+{
+    WIFI_STORAGE_FLASH = 0,
+    WIFI_STORAGE_RAM,
+} wifi_storage_t;
+
+typedef struct
+{
+    int magic;
+} wifi_init_config_t;
+
+typedef struct
+{
+    int8_t rssi;
+    wifi_auth_mode_t authmode;
+} wifi_scan_threshold_t;
+
+typedef struct
+{
+    uint8_t ssid[32];
+    uint8_t password[64];
+    wifi_scan_method_t scan_method;
+    bool bssid_set;
+    uint8_t bssid[6];
+    uint8_t channel;
+    wifi_scan_threshold_t threshold;
+    wifi_sae_pwe_method_t sae_pwe_h2e;
+    uint8_t sae_h2e_identifier[32];
+} wifi_sta_config_t;
+
+typedef union
+{
+    wifi_sta_config_t sta;
+} wifi_config_t;
+
+typedef struct
+{
+    uint8_t ssid[32];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t channel;
+    wifi_auth_mode_t authmode;
+    uint16_t aid;
+} wifi_event_sta_connected_t;
+
+typedef struct
+{
+    uint8_t ssid[32];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t reason;
+    int8_t rssi;
+} wifi_event_sta_disconnected_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+esp_err_t esp_wifi_init(const wifi_init_config_t *config);
+esp_err_t esp_wifi_deinit(void);
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode);
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage);
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf);
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t *conf);
+esp_err_t esp_wifi_start(void);
+esp_err_t esp_wifi_stop(void);
+esp_err_t esp_wifi_connect(void);
+esp_err_t esp_wifi_disconnect(void);
+esp_err_t esp_wifi_sta_get_rssi(int *rssi);
+#endif /* ESP_WIFI_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,59 @@
+/**
+ * @file prj_sim_wifi.h
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef PRJ_SIM_WIFI_H
+#define PRJ_SIM_WIFI_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "prj_common.h"
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    prj_u32_t assoc_delay_ms; /*!< Time from esp_wifi_connect() to the connected or failed event */
+    prj_u32_t dhcp_delay_ms;  /*!< Time from association to the got IP event */
+    prj_u32_t fail_count;     /*!< Number of next connect attempts that fail with no AP found */
+    prj_u8_t bssid[6];        /*!< AP address, a targeted connect to another one fails */
+    prj_u8_t channel;         /*!< AP channel, a targeted connect on another one fails */
+    prj_u32_t ip;             /*!< Leased address, network byte order */
+    prj_i8_t rssi;            /*!< Signal level reported while associated */
+} prj_sim_wifi_ap_t;
+
+typedef struct
+{
+    prj_u32_t connect_calls; /*!< esp_wifi_connect() calls */
+    prj_u32_t connected;     /*!< Successful associations */
+    prj_u32_t failed;        /*!< Failed attempts */
+    prj_u32_t dropped;       /*!< Links dropped by prj_sim_wifi_link_drop() */
+} prj_sim_wifi_stats_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/**
+ * @brief Replace the simulated AP. Applies to the next connect attempt.
+ */
+void prj_sim_wifi_ap_set(const prj_sim_wifi_ap_t *const p_ap);
+
+/**
+ * @brief Drop the link with a beacon timeout and fail the next connect attempts.
+ *
+ * @param fail_count Number of reconnect attempts that fail before the AP is back.
+ */
+void prj_sim_wifi_link_drop(const prj_u32_t fail_count);
+
+/**
+ * @brief Get and clear the driver counters.
+ */
+void prj_sim_wifi_stats_take(prj_sim_wifi_stats_t *const p_stats);
+#endif /* PRJ_SIM_WIFI_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
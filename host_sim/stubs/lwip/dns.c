@@ -0,0 +1,42 @@
+/**
+ * @file dns.c
+ * @date 06/10/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "lwip/dns.h"
+#include "lwip/tcpip.h"
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+err_t dns_gethostbyname_addrtype(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *callback_arg,
+                                 uint8_t dns_addrtype)
+{
+    struct in_addr in = {0};
+
+    /* Like lwIP, an address literal is answered without a lookup */
+    if (inet_pton(AF_INET, hostname, &in) != 1)
+    {
+        return ERR_ARG;
+    }
+
+    addr->addr = in.s_addr;
+
+    return ERR_OK;
+}
+
+err_t tcpip_callback(tcpip_callback_fn function, void *ctx)
+{
+    function(ctx);
+
+    return ERR_OK;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,155 @@
+/**
+ * @file esp_sntp.c
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "esp_sntp.h"
+#include "prj_sim_sntp.h"
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static void prj_sim_sntp_timer_cb(void *p_arg);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t m_timer = NULL;
+static sntp_sync_time_cb_t m_cb = NULL;
+static prj_sim_sntp_t m_sntp = {0};
+static prj_u32_t m_requests = 0U;
+static prj_bool_t m_enabled = false;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void esp_sntp_setoperatingmode(sntp_operatingmode_t operating_mode)
+{
+    return;
+}
+
+void esp_sntp_setservername(uint8_t idx, const char *server)
+{
+    return;
+}
+
+void esp_sntp_init(void)
+{
+    const esp_timer_create_args_t timer_args = {
+        .callback = prj_sim_sntp_timer_cb,
+        .name     = "sim_sntp",
+    };
+    prj_bool_t lost = false;
+    prj_u32_t delay_ms = 0U;
+
+    if ((m_timer == NULL) && (esp_timer_create(&timer_args, &m_timer) != ESP_OK))
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+    m_enabled = true;
+    m_requests++;
+    lost = m_sntp.lost;
+    delay_ms = m_sntp.reply_delay_ms;
+    portEXIT_CRITICAL(&m_lock);
+
+    if (!lost)
+    {
+        esp_timer_start_once(m_timer, (uint64_t)delay_ms * 1000U);
+    }
+
+    return;
+}
+
+void esp_sntp_stop(void)
+{
+    if (m_timer != NULL)
+    {
+        esp_timer_stop(m_timer);
+    }
+
+    portENTER_CRITICAL(&m_lock);
+    m_enabled = false;
+    portEXIT_CRITICAL(&m_lock);
+
+    return;
+}
+
+bool esp_sntp_enabled(void)
+{
+    return m_enabled;
+}
+
+void sntp_set_sync_mode(sntp_sync_mode_t sync_mode)
+{
+    return;
+}
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback)
+{
+    portENTER_CRITICAL(&m_lock);
+    m_cb = callback;
+    portEXIT_CRITICAL(&m_lock);
+
+    return;
+}
+
+void prj_sim_sntp_set(const prj_sim_sntp_t *const p_sntp)
+{
+    portENTER_CRITICAL(&m_lock);
+    m_sntp = *p_sntp;
+    portEXIT_CRITICAL(&m_lock);
+
+    return;
+}
+
+prj_u32_t prj_sim_sntp_requests_take(void)
+{
+    prj_u32_t requests = 0U;
+
+    portENTER_CRITICAL(&m_lock);
+    requests = m_requests;
+    m_requests = 0U;
+    portEXIT_CRITICAL(&m_lock);
+
+    return requests;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static void prj_sim_sntp_timer_cb(void *p_arg)
+{
+    sntp_sync_time_cb_t cb = NULL;
+    prj_i64_t (*p_server_us)(void) = NULL;
+    struct timeval tv = {0};
+    prj_i64_t server_us = 0;
+
+    portENTER_CRITICAL(&m_lock);
+    cb = m_enabled ? m_cb : NULL;
+    p_server_us = m_sntp.p_server_us;
+    portEXIT_CRITICAL(&m_lock);
+
+    if ((cb == NULL) || (p_server_us == NULL))
+    {
+        return;
+    }
+
+    server_us = p_server_us();
+    tv.tv_sec = (time_t)(server_us / 1000000LL);
+    tv.tv_usec = (suseconds_t)(server_us % 1000000LL);
+    cb(&tv);
+
+    return;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
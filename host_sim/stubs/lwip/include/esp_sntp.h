@@ -0,0 +1,50 @@
+/**
+ * @file esp_sntp.h
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ *
+ * Host stub of the lwIP SNTP client. The reply is scripted through prj_sim_sntp.h, the system
+ * clock is never touched.
+ */
+
+#ifndef ESP_SNTP_H
+#define ESP_SNTP_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/time.h>
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef enum
+{
+    SNTP_OPMODE_POLL,
+    SNTP_OPMODE_LISTENONLY,
+} sntp_operatingmode_t;
+
+typedef enum
+{
+    SNTP_SYNC_MODE_IMMED,
+    SNTP_SYNC_MODE_SMOOTH,
+} sntp_sync_mode_t;
+
+typedef void (*sntp_sync_time_cb_t)(struct timeval *tv);
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+void esp_sntp_setoperatingmode(sntp_operatingmode_t operating_mode);
+void esp_sntp_setservername(uint8_t idx, const char *server);
+void esp_sntp_init(void);
+void esp_sntp_stop(void);
+bool esp_sntp_enabled(void);
+void sntp_set_sync_mode(sntp_sync_mode_t sync_mode);
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback);
+#endif /* ESP_SNTP_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
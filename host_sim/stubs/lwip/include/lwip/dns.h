@@ -0,0 +1,35 @@
+/**
+ * @file dns.h
+ * @date 06/10/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ *
+ * Host stub, only numeric addresses resolve and they do so at once.
+ */
+
+#ifndef LWIP_DNS_H
+#define LWIP_DNS_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "lwip/ip_addr.h"
+#include "lwip/err.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define LWIP_DNS_ADDRTYPE_IPV4 (0U)
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef void (*dns_found_callback)(const char *name, const ip_addr_t *ipaddr, void *callback_arg);
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+err_t dns_gethostbyname_addrtype(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *callback_arg,
+                                 uint8_t dns_addrtype);
+#endif /* LWIP_DNS_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
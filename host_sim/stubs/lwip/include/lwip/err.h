@@ -0,0 +1,31 @@
+/**
+ * @file err.h
+ * @date 06/10/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ *
+ * Host stub, the lwIP codes the components check for.
+ */
+
+#ifndef LWIP_ERR_H
+#define LWIP_ERR_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include <stdint.h>
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define ERR_OK         (0)
+#define ERR_INPROGRESS (-5)
+#define ERR_ARG        (-16)
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef int8_t err_t;
+#endif /* LWIP_ERR_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
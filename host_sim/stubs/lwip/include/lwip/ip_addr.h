@@ -0,0 +1,35 @@
+/**
+ * @file ip_addr.h
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ *
+ * Host stub, sockets come from the host C library.
+ */
+
+#ifndef LWIP_IP_ADDR_H
+#define LWIP_IP_ADDR_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include <stdint.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+/***************************************************************************************************
+ * Macros
+ **************************************************************************************************/
+#define ip_2_ip4(ipaddr)             (ipaddr)
+#define ip4_addr_get_u32(src_ipaddr) ((src_ipaddr)->addr)
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    uint32_t addr; /*!< IPv4 address in network order */
+} ip_addr_t;
+#endif /* LWIP_IP_ADDR_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
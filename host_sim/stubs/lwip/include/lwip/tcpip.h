@@ -0,0 +1,29 @@
+/**
+ * @file tcpip.h
+ * @date 06/10/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ *
+ * Host stub, there is no TCP/IP thread and callbacks run in the caller.
+ */
+
+#ifndef LWIP_TCPIP_H
+#define LWIP_TCPIP_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "lwip/err.h"
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef void (*tcpip_callback_fn)(void *ctx);
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+err_t tcpip_callback(tcpip_callback_fn function, void *ctx);
+#endif /* LWIP_TCPIP_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,40 @@
+/**
+ * @file prj_sim_sntp.h
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef PRJ_SIM_SNTP_H
+#define PRJ_SIM_SNTP_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "prj_common.h"
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    prj_u32_t reply_delay_ms;       /*!< Time from esp_sntp_init() to the notification */
+    prj_bool_t lost;                /*!< Server never answers */
+    prj_i64_t (*p_server_us)(void); /*!< Reference time reported by the server, UTC microseconds */
+} prj_sim_sntp_t;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+/**
+ * @brief Script the server behaviour for the next esp_sntp_init().
+ */
+void prj_sim_sntp_set(const prj_sim_sntp_t *const p_sntp);
+
+/**
+ * @brief Get and clear the number of esp_sntp_init() calls.
+ */
+prj_u32_t prj_sim_sntp_requests_take(void);
+#endif /* PRJ_SIM_SNTP_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
@@ -0,0 +1,24 @@
+/**
+ * @file nvs_flash.h
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+#ifndef NVS_FLASH_H
+#define NVS_FLASH_H
+/***************************************************************************************************
+ * Includes
+ *************************************************************************************************/
+#include "nvs.h"
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
+#endif /* NVS_FLASH_H */
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
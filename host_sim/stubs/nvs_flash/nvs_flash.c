@@ -0,0 +1,224 @@
+/**
+ * @file nvs_flash.c
+ * @date 05/26/2025
+ * @copyright © Promwad GmbH, 2024-2025.
+ *
+ * @copyright Use of this source code is governed by the respective Software development
+ * agreement/Master service agreement concluded with the Promwad GmbH.
+ */
+
+/***************************************************************************************************
+ * Includes
+ **************************************************************************************************/
+#include "nvs_flash.h"
+
+#include <string.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+/***************************************************************************************************
+ * Definitions
+ **************************************************************************************************/
+#define NVS_STUB_ENTRY_MAX   (16U)
+#define NVS_STUB_NS_MAX      (8U)
+#define NVS_STUB_NAME_SIZE   (16U)
+#define NVS_STUB_BLOB_SIZE   (256U)
+#define NVS_STUB_HANDLE_RO   (0x80000000U)
+/***************************************************************************************************
+ * Types
+ **************************************************************************************************/
+typedef struct
+{
+    uint32_t ns;
+    char key[NVS_STUB_NAME_SIZE];
+    uint8_t value[NVS_STUB_BLOB_SIZE];
+    size_t length;
+    bool used;
+} nvs_stub_entry_t;
+/***************************************************************************************************
+ * Static functions declaration
+ **************************************************************************************************/
+static nvs_stub_entry_t *nvs_stub_find(const uint32_t ns, const char *const p_key);
+/***************************************************************************************************
+ * Variables
+ **************************************************************************************************/
+static portMUX_TYPE m_lock = portMUX_INITIALIZER_UNLOCKED;
+static char m_namespaces[NVS_STUB_NS_MAX][NVS_STUB_NAME_SIZE];
+static nvs_stub_entry_t m_entries[NVS_STUB_ENTRY_MAX];
+static bool m_ready = false;
+/***************************************************************************************************
+ * API
+ **************************************************************************************************/
+esp_err_t nvs_flash_init(void)
+{
+    m_ready = true;
+
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    portENTER_CRITICAL(&m_lock);
+    memset(m_entries, 0, sizeof(m_entries));
+    portEXIT_CRITICAL(&m_lock);
+
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    esp_err_t err = ESP_ERR_NVS_NOT_FOUND;
+
+    if (!m_ready)
+    {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+
+    for (uint32_t i = 0U; i < NVS_STUB_NS_MAX; i++)
+    {
+        if ((m_namespaces[i][0] == '\0') && (open_mode == NVS_READWRITE))
+        {
+            strncpy(m_namespaces[i], namespace_name, NVS_STUB_NAME_SIZE - 1U);
+        }
+
+        if (strncmp(m_namespaces[i], namespace_name, NVS_STUB_NAME_SIZE - 1U) == 0)
+        {
+            *out_handle = (i + 1U) | ((open_mode == NVS_READONLY) ? NVS_STUB_HANDLE_RO : 0U);
+            err = ESP_OK;
+            break;
+        }
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    return err;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    return;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    nvs_stub_entry_t *p_entry = NULL;
+    esp_err_t err = ESP_OK;
+
+    portENTER_CRITICAL(&m_lock);
+
+    p_entry = nvs_stub_find(handle & ~NVS_STUB_HANDLE_RO, key);
+
+    if (p_entry == NULL)
+    {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    }
+    else if (out_value == NULL)
+    {
+        *length = p_entry->length;
+    }
+    else if (*length < p_entry->length)
+    {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    else
+    {
+        memcpy(out_value, p_entry->value, p_entry->length);
+        *length = p_entry->length;
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    return err;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    nvs_stub_entry_t *p_entry = NULL;
+    esp_err_t err = ESP_OK;
+
+    if (handle & NVS_STUB_HANDLE_RO)
+    {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+
+    if (length > NVS_STUB_BLOB_SIZE)
+    {
+        return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+
+    p_entry = nvs_stub_find(handle, key);
+
+    for (uint32_t i = 0U; (p_entry == NULL) && (i < NVS_STUB_ENTRY_MAX); i++)
+    {
+        if (!m_entries[i].used)
+        {
+            p_entry = &m_entries[i];
+            p_entry->ns = handle;
+            strncpy(p_entry->key, key, NVS_STUB_NAME_SIZE - 1U);
+            p_entry->used = true;
+        }
+    }
+
+    if (p_entry != NULL)
+    {
+        memcpy(p_entry->value, value, length);
+        p_entry->length = length;
+    }
+    else
+    {
+        err = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    return err;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    nvs_stub_entry_t *p_entry = NULL;
+
+    if (handle & NVS_STUB_HANDLE_RO)
+    {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+
+    p_entry = nvs_stub_find(handle, key);
+
+    if (p_entry != NULL)
+    {
+        memset(p_entry, 0, sizeof(*p_entry));
+    }
+
+    portEXIT_CRITICAL(&m_lock);
+
+    return (p_entry != NULL) ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return ESP_OK;
+}
+/***************************************************************************************************
+ * STATIC
+ **************************************************************************************************/
+static nvs_stub_entry_t *nvs_stub_find(const uint32_t ns, const char *const p_key)
+{
+    for (uint32_t i = 0U; i < NVS_STUB_ENTRY_MAX; i++)
+    {
+        if (m_entries[i].used && (m_entries[i].ns == ns) && (strncmp(m_entries[i].key, p_key, NVS_STUB_NAME_SIZE - 1U) == 0))
+        {
+            return &m_entries[i];
+        }
+    }
+
+    return NULL;
+}
+/***************************************************************************************************
+ * EOF
+ **************************************************************************************************/
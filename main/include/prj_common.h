@@ -51,6 +51,7 @@ typedef uint64_t prj_u64_t;
 typedef uint32_t prj_u32_t;
 typedef uint16_t prj_u16_t;
 typedef uint8_t  prj_u8_t;
+typedef int64_t  prj_i64_t;
 typedef int32_t  prj_i32_t;
 typedef int16_t  prj_i16_t;
 typedef int8_t 	 prj_i8_t;
@@ -9,32 +9,333 @@
 #include "esp_log.h"
 #include "sdkconfig.h"
 #include <inttypes.h>
+#include "nvs_flash.h"
+#include "esp_netif.h"
+#include "esp_event.h"
+#include "prj_button.h"
+#include "prj_led.h"
+#include "prj_log.h"
+#include "prj_metrics.h"
+#include "prj_prof.h"
+#include "prj_startup.h"
+#include "wifi_sta.h"
+#include "time_sync.h"
+#if CONFIG_PRJ_METRICS_CONSOLE
+#include "esp_console.h"
+#endif
 /***************************************************************************************************
 * Definitions
 **************************************************************************************************/
+#define MAIN_TAG "MAIN"
+#define MAIN_CONSOLE_PROMPT "prj>"
 
+typedef enum
+{
+    MAIN_STARTUP_NVS = 0,
+    MAIN_STARTUP_NETIF,
+    MAIN_STARTUP_EVENT_LOOP,
+    MAIN_STARTUP_TIME_RESTORE,
+    MAIN_STARTUP_LED,
+    MAIN_STARTUP_WIFI_STA,
+    MAIN_STARTUP_TIME_SYNC,
+    MAIN_STARTUP_BUTTON,
+#if CONFIG_PRJ_METRICS_CONSOLE
+    MAIN_STARTUP_CONSOLE,
+#endif
+    MAIN_STARTUP_MAX,
+} main_startup_index_t;
 
 /***************************************************************************************************
-* Variables
+* Static functions declaration
 **************************************************************************************************/
-
+static prj_status_t main_nvs_init(void);
+static prj_status_t main_nvs_deinit(void);
+static prj_status_t main_netif_init(void);
+static prj_status_t main_event_loop_init(void);
+static prj_status_t main_event_loop_deinit(void);
+static prj_status_t main_time_restore_init(void);
+static prj_status_t main_wifi_sta_init(void);
+static prj_status_t main_time_sync_init(void);
+static void main_time_sync_wifi_sta_cb(const prj_wifi_sta_event_t event, void *const p_ctx);
+static prj_status_t main_led_init(void);
+static void main_led_wifi_sta_cb(const prj_wifi_sta_event_t event, void *const p_ctx);
+static void main_led_time_sync_cb(const prj_time_sync_event_t event, void *const p_ctx);
+#if CONFIG_PRJ_METRICS_CONSOLE
+static prj_status_t main_console_init(void);
+static prj_status_t main_console_deinit(void);
+#endif
 
 /***************************************************************************************************
-* Static functions declaration
+* Variables
 **************************************************************************************************/
+static const prj_startup_entry_t m_startup[MAIN_STARTUP_MAX] = {
+    [MAIN_STARTUP_NVS] = {
+        .p_name = "nvs",
+        .init   = main_nvs_init,
+        .deinit = main_nvs_deinit,
+        .core   = tskNO_AFFINITY,
+    },
+    /* esp_netif cannot be deinitialized */
+    [MAIN_STARTUP_NETIF] = {
+        .p_name = "netif",
+        .init   = main_netif_init,
+        .core   = tskNO_AFFINITY,
+    },
+    [MAIN_STARTUP_EVENT_LOOP] = {
+        .p_name = "event_loop",
+        .init   = main_event_loop_init,
+        .deinit = main_event_loop_deinit,
+        .core   = tskNO_AFFINITY,
+    },
+    [MAIN_STARTUP_TIME_RESTORE] = {
+        .p_name = "time_restore",
+        .init   = main_time_restore_init,
+        .deps   = PRJ_STARTUP_DEP(MAIN_STARTUP_NVS),
+        .core   = tskNO_AFFINITY,
+    },
+    [MAIN_STARTUP_LED] = {
+        .p_name = "led",
+        .init   = main_led_init,
+        .deinit = prj_led_deinit,
+        .core   = tskNO_AFFINITY,
+    },
+    /* The LED callbacks must be registered before the first station event */
+    [MAIN_STARTUP_WIFI_STA] = {
+        .p_name = "wifi_sta",
+        .init   = main_wifi_sta_init,
+        .deinit = prj_wifi_sta_deinit,
+        .deps   = PRJ_STARTUP_DEP(MAIN_STARTUP_NVS) | PRJ_STARTUP_DEP(MAIN_STARTUP_NETIF) | PRJ_STARTUP_DEP(MAIN_STARTUP_EVENT_LOOP) |
+                  PRJ_STARTUP_DEP(MAIN_STARTUP_LED),
+        .core   = 0,
+    },
+    [MAIN_STARTUP_TIME_SYNC] = {
+        .p_name = "time_sync",
+        .init   = main_time_sync_init,
+        .deinit = prj_time_sync_deinit,
+        .deps   = PRJ_STARTUP_DEP(MAIN_STARTUP_WIFI_STA) | PRJ_STARTUP_DEP(MAIN_STARTUP_TIME_RESTORE),
+        .core   = tskNO_AFFINITY,
+    },
+    /* The GPIO interrupt is allocated on the core the entry runs on, keep it off the Wi-Fi core */
+    [MAIN_STARTUP_BUTTON] = {
+        .p_name = "button",
+        .init   = prj_button_init,
+        .deinit = prj_button_deinit,
+        .core   = portNUM_PROCESSORS - 1,
+    },
+#if CONFIG_PRJ_METRICS_CONSOLE
+    [MAIN_STARTUP_CONSOLE] = {
+        .p_name = "console",
+        .init   = main_console_init,
+        .deinit = main_console_deinit,
+        .core   = tskNO_AFFINITY,
+    },
+#endif
+};
+
+#if CONFIG_PRJ_METRICS_CONSOLE
+static esp_console_repl_t *m_repl = NULL;
+#endif
 
+static prj_startup_report_t m_startup_report[MAIN_STARTUP_MAX];
 
 /***************************************************************************************************
 * API
 **************************************************************************************************/
 void app_main(void)
 {
-    ;
+    prj_log_init();
+
+    if (prj_startup_run(m_startup, MAIN_STARTUP_MAX, m_startup_report) != PRJ_SUCCESS)
+    {
+        ESP_LOGE(MAIN_TAG, "app main: startup incomplete");
+    }
+
+    prj_startup_report_print(m_startup, MAIN_STARTUP_MAX, m_startup_report);
 }
 
 /***************************************************************************************************
 * STATIC
 **************************************************************************************************/
+static prj_status_t main_nvs_init(void)
+{
+    /* Never erased here, it holds the Wi-Fi calibration and the fast reconnect cache */
+    return (nvs_flash_init() == ESP_OK) ? PRJ_SUCCESS : PRJ_ERROR_INCONSISTENT_STORAGE;
+}
+
+static prj_status_t main_nvs_deinit(void)
+{
+    return (nvs_flash_deinit() == ESP_OK) ? PRJ_SUCCESS : PRJ_ERROR_INVALID_STATE;
+}
+
+static prj_status_t main_netif_init(void)
+{
+    esp_err_t err = ESP_OK;
+
+    prj_prof_begin(PRJ_PROF_PHASE_NETIF_INIT);
+    err = esp_netif_init();
+    prj_prof_end(PRJ_PROF_PHASE_NETIF_INIT);
+
+    return (err == ESP_OK) ? PRJ_SUCCESS : PRJ_ERROR_INTERNAL;
+}
+
+static prj_status_t main_event_loop_init(void)
+{
+    esp_err_t err = esp_event_loop_create_default();
+
+    /* Already created by another component is fine */
+    return ((err == ESP_OK) || (err == ESP_ERR_INVALID_STATE)) ? PRJ_SUCCESS : PRJ_ERROR_RESOURCES;
+}
+
+static prj_status_t main_event_loop_deinit(void)
+{
+    return (esp_event_loop_delete_default() == ESP_OK) ? PRJ_SUCCESS : PRJ_ERROR_INVALID_STATE;
+}
+
+static prj_status_t main_time_restore_init(void)
+{
+    /* Nothing to restore after power loss, the sync will set the clock */
+    prj_time_sync_restore();
+
+    return PRJ_SUCCESS;
+}
+
+static prj_status_t main_wifi_sta_init(void)
+{
+    /* The connection comes up in the background, the entries depending on it do not wait for it */
+    return prj_wifi_sta_start(NULL);
+}
+
+static prj_status_t main_time_sync_init(void)
+{
+    static prj_bool_t registered = false;
+    prj_status_t status = PRJ_SUCCESS;
+
+    /* Callbacks cannot be unregistered, keep it across deinit and init */
+    if (!registered)
+    {
+        prj_wifi_sta_cb_register(main_time_sync_wifi_sta_cb, NULL);
+        registered = true;
+    }
+
+    /* The first sync runs on the service task, it skips it while the restored time is accurate */
+    status = prj_time_sync_background_start();
+
+    /* The link may have come up before the callback was registered */
+    if ((status == PRJ_SUCCESS) && ((prj_wifi_sta_wait(PRJ_WIFI_STA_BIT_GOT_IP, 0U) & PRJ_WIFI_STA_BIT_GOT_IP) != 0U))
+    {
+        prj_time_sync_radio_awake();
+    }
+
+    return status;
+}
+
+static void main_time_sync_wifi_sta_cb(const prj_wifi_sta_event_t event, void *const p_ctx)
+{
+    if (event == PRJ_WIFI_STA_EVENT_GOT_IP)
+    {
+        prj_time_sync_radio_awake();
+    }
+
+    return;
+}
+
+static prj_status_t main_led_init(void)
+{
+    static prj_bool_t registered = false;
+
+    /* Callbacks cannot be unregistered, keep them across deinit and init */
+    if (!registered)
+    {
+        prj_wifi_sta_cb_register(main_led_wifi_sta_cb, NULL);
+        prj_time_sync_cb_register(main_led_time_sync_cb, NULL);
+        registered = true;
+    }
+
+    prj_led_state_set(PRJ_LED_STATE_CONNECTING, true);
+
+    return prj_led_init();
+}
+
+static void main_led_wifi_sta_cb(const prj_wifi_sta_event_t event, void *const p_ctx)
+{
+    switch (event)
+    {
+        case PRJ_WIFI_STA_EVENT_GOT_IP:
+        case PRJ_WIFI_STA_EVENT_LINK_UP:
+            /* Set before clearing, so the LED switches straight to the new pattern */
+            prj_led_state_set(PRJ_LED_STATE_CONNECTED, true);
+            prj_led_state_set(PRJ_LED_STATE_CONNECTING, false);
+            break;
+
+        case PRJ_WIFI_STA_EVENT_LOST_IP:
+        case PRJ_WIFI_STA_EVENT_LINK_DOWN:
+            prj_led_state_set(PRJ_LED_STATE_CONNECTING, true);
+            prj_led_state_set(PRJ_LED_STATE_CONNECTED, false);
+            break;
+
+        default:
+            break;
+    }
+
+    return;
+}
+
+static void main_led_time_sync_cb(const prj_time_sync_event_t event, void *const p_ctx)
+{
+    prj_led_state_set(PRJ_LED_STATE_SYNC_FAILED, event == PRJ_TIME_SYNC_EVENT_FAILED);
+
+    return;
+}
+
+#if CONFIG_PRJ_METRICS_CONSOLE
+static prj_status_t main_console_init(void)
+{
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    esp_err_t err = ESP_OK;
+
+    repl_config.prompt = MAIN_CONSOLE_PROMPT;
+
+#if CONFIG_ESP_CONSOLE_UART_DEFAULT || CONFIG_ESP_CONSOLE_UART_CUSTOM
+    esp_console_dev_uart_config_t dev_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    err = esp_console_new_repl_uart(&dev_config, &repl_config, &m_repl);
+#elif CONFIG_ESP_CONSOLE_USB_CDC
+    esp_console_dev_usb_cdc_config_t dev_config = ESP_CONSOLE_DEV_CDC_CONFIG_DEFAULT();
+    err = esp_console_new_repl_usb_cdc(&dev_config, &repl_config, &m_repl);
+#elif CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG
+    esp_console_dev_usb_serial_jtag_config_t dev_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    err = esp_console_new_repl_usb_serial_jtag(&dev_config, &repl_config, &m_repl);
+#else
+    err = ESP_ERR_NOT_SUPPORTED;
+#endif
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(MAIN_TAG, "console init: repl not created (%s)", esp_err_to_name(err));
+        return PRJ_ERROR_RESOURCES;
+    }
+
+    esp_console_register_help_command();
+
+    if ((prj_metrics_console_register() != PRJ_SUCCESS) || (esp_console_start_repl(m_repl) != ESP_OK))
+    {
+        main_console_deinit();
+        return PRJ_ERROR_RESOURCES;
+    }
+
+    return PRJ_SUCCESS;
+}
+
+static prj_status_t main_console_deinit(void)
+{
+    if (m_repl != NULL)
+    {
+        m_repl->del(m_repl);
+        m_repl = NULL;
+    }
+
+    return PRJ_SUCCESS;
+}
+#endif
 
 /***************************************************************************************************
 * EOF